@@ -0,0 +1,568 @@
+#include "ofApp.h"
+
+using namespace ofxLaser;
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+
+	ofBackground(15,15,20);
+	runBenchmarks();
+
+}
+
+//--------------------------------------------------------------
+void ofApp::update(){
+
+}
+
+void ofApp::draw() {
+
+	ofSetColor(255);
+	float y = 30;
+	for(string& result : results) {
+		ofDrawBitmapString(result, 20, y);
+		y+=16;
+	}
+	ofDrawBitmapString("Press space to run again", 20, ofGetHeight()-20);
+
+}
+
+void ofApp::runBenchmarks() {
+
+	results.clear();
+	addResult("ofxLaser benchmarks");
+	addResult("");
+	checkRenderThreadPool();
+	benchmarkWarpUpdate();
+	benchmarkOutputTransform();
+	benchmarkZoneAssignment();
+	benchmarkZoneBalancing();
+	benchmarkEtherdream();
+	benchmarkIDN();
+
+}
+
+void ofApp::checkRenderThreadPool() {
+
+	// ManagerBase::send changes the number of threads and then runs the
+	// lasers straight away, before the new threads have had a chance to
+	// start. If the pool gets that wrong this never finishes.
+	addResult("RENDER THREADS");
+	int failed = 0;
+	int numruns = 0;
+	for(int test = 0; test<50; test++) {
+		RenderThreadPool pool;
+		for(int i = 0; i<20; i++) {
+			pool.setNumThreads((i%2==0) ? 3 : 7);
+			std::atomic<int> sum(0);
+			pool.run(8, [&](int index) { sum+=index; });
+			if(sum!=28) failed++;
+			numruns++;
+		}
+	}
+	addResult("Run straight after changing the threads, " + ofToString(numruns) + " runs : " + ((failed==0) ? "OK" : ofToString(failed) + " failed"));
+	addResult("");
+
+}
+
+void ofApp::benchmarkWarpUpdate() {
+
+	// lots of zones with an 8 x 8 grid, which is the worst case when you
+	// load the settings or drag a handle
+	int numZones = 16;
+	int divisions = 8;
+	int repeats = 20;
+
+	ofSeedRandom(1);
+	vector<std::unique_ptr<ZoneTransform>> zones;
+	for(int i = 0; i<numZones; i++) {
+		zones.emplace_back(new ZoneTransform());
+		ZoneTransform& zone = *zones.back();
+		zone.setSrc(ofRectangle(0,0,800,800));
+		zone.setDivisions(divisions, divisions);
+		// give it some perspective so it's not just a simple scale
+		zone.setDstCorners(glm::vec3(ofRandom(0,100), ofRandom(0,100),0),
+						   glm::vec3(ofRandom(700,800), ofRandom(0,100),0),
+						   glm::vec3(ofRandom(0,100), ofRandom(700,800),0),
+						   glm::vec3(ofRandom(700,800), ofRandom(700,800),0));
+	}
+
+	uint64_t starttime = ofGetElapsedTimeMicros();
+	for(int r = 0; r<repeats; r++) {
+		for(auto& zone : zones) zone->updateHomography();
+	}
+	float updatetime = (ofGetElapsedTimeMicros()-starttime)/1000.0f/repeats;
+
+	addResult("WARP UPDATE");
+	addResult(ofToString(numZones) + " zones, " + ofToString(divisions) + "x" + ofToString(divisions) + " subdivisions");
+	addResult("Update all zones : " + ofToString(updatetime, 3) + "ms");
+
+	// then compare a single quad against OpenCV
+	int numQuads = 10000;
+	vector<glm::vec3> src(numQuads*4), dst(numQuads*4);
+	for(int i = 0; i<numQuads; i++) {
+		glm::vec3 topleft(ofRandom(0,700), ofRandom(0,700), 0);
+		float size = ofRandom(10,100);
+		src[i*4] = topleft;
+		src[i*4+1] = topleft+glm::vec3(size,0,0);
+		src[i*4+2] = topleft+glm::vec3(0,size,0);
+		src[i*4+3] = topleft+glm::vec3(size,size,0);
+		for(int j = 0; j<4; j++) {
+			dst[i*4+j] = (src[i*4+j]*1.2f) + glm::vec3(ofRandom(-5,5), ofRandom(-5,5), 0);
+		}
+	}
+
+	Warper warper;
+	starttime = ofGetElapsedTimeMicros();
+	float maxerror = 0;
+	for(int i = 0; i<numQuads; i++) {
+		warper.updateHomography(src[i*4], src[i*4+1], src[i*4+2], src[i*4+3], dst[i*4], dst[i*4+1], dst[i*4+2], dst[i*4+3]);
+		for(int j = 0; j<4; j++) {
+			maxerror = MAX(maxerror, glm::distance(warper.getWarpedPoint(src[i*4+j]), dst[i*4+j]));
+		}
+	}
+	float closedformtime = (ofGetElapsedTimeMicros()-starttime)/(float)numQuads;
+
+	vector<cv::Point2f> srcCV(4), dstCV(4);
+	starttime = ofGetElapsedTimeMicros();
+	for(int i = 0; i<numQuads; i++) {
+		for(int j = 0; j<4; j++) {
+			srcCV[j] = cv::Point2f(src[i*4+j].x, src[i*4+j].y);
+			dstCV[j] = cv::Point2f(dst[i*4+j].x, dst[i*4+j].y);
+		}
+		cv::Mat homography = cv::findHomography(cv::Mat(srcCV), cv::Mat(dstCV), 8, 100);
+		cv::Mat inverse = homography.inv();
+	}
+	float opencvtime = (ofGetElapsedTimeMicros()-starttime)/(float)numQuads;
+
+	addResult("Per quad, closed form : " + ofToString(closedformtime, 3) + "us");
+	addResult("Per quad, cv::findHomography : " + ofToString(opencvtime, 3) + "us");
+	addResult("Max corner error : " + ofToString(maxerror, 6));
+	addResult("");
+
+}
+
+// the way Laser::processPoints used to do it, point by point
+static void transformPointsOld(vector<Point>& points, glm::vec2 outputOffset, bool flipX, bool flipY, float rotation) {
+	for(size_t i = 0; i<points.size(); i++) {
+		Point& p = points[i];
+		p+=(ofPoint)outputOffset;
+		if(flipY) p.y= 800-p.y;
+		if(flipX) p.x= 800-p.x;
+		if(rotation!=0) {
+			p.x-=400;
+			p.y-=400;
+			glm::vec3 vec = glm::vec3(p.x,p.y,0);
+			float angle = ofDegToRad(rotation);
+			glm::vec2 rotatedVec = glm::rotate(vec, angle, glm::vec3(0.0f, 0.0f, 1.0f));
+			p.x=rotatedVec.x+400;
+			p.y=rotatedVec.y+400;
+		}
+		if(p.x<0) {
+			p.x = p.r = p.g = p.b = 0;
+		} else if(p.x>800) {
+			p.x = 800;
+			p.r = p.g = p.b = 0;
+		}
+		if(p.y<0) {
+			p.y = p.r = p.g = p.b = 0;
+		} else if(p.y>800) {
+			p.y = 800;
+			p.r = p.g = p.b = 0;
+		}
+	}
+}
+
+void ofApp::benchmarkOutputTransform() {
+
+	// about a frame's worth of points at a high point rate
+	int numPoints = 30000;
+	int repeats = 200;
+	glm::vec2 offset(3.5, -7.25);
+	bool flipX = true;
+	bool flipY = false;
+	float rotation = 12.5;
+
+	ofSeedRandom(2);
+	vector<Point> source(numPoints);
+	for(Point& p : source) {
+		p.set(ofRandom(-10,810), ofRandom(-10,810));
+		p.r = p.g = p.b = 255;
+	}
+	vector<Point> oldpoints, newpoints;
+
+	uint64_t oldtime = 0;
+	uint64_t newtime = 0;
+	for(int r = 0; r<repeats; r++) {
+		oldpoints = source;
+		uint64_t starttime = ofGetElapsedTimeMicros();
+		transformPointsOld(oldpoints, offset, flipX, flipY, rotation);
+		oldtime += ofGetElapsedTimeMicros()-starttime;
+
+		newpoints = source;
+		starttime = ofGetElapsedTimeMicros();
+		OutputTransform transform;
+		transform.set(offset, flipX, flipY, rotation);
+		transform.apply(newpoints.data(), newpoints.size());
+		newtime += ofGetElapsedTimeMicros()-starttime;
+	}
+
+	float maxdifference = 0;
+	int colourdifferences = 0;
+	for(int i = 0; i<numPoints; i++) {
+		maxdifference = MAX(maxdifference, glm::distance(glm::vec2(oldpoints[i].x, oldpoints[i].y), glm::vec2(newpoints[i].x, newpoints[i].y)));
+		if(oldpoints[i].getColour()!=newpoints[i].getColour()) colourdifferences++;
+	}
+
+	addResult("OUTPUT TRANSFORM");
+	addResult(ofToString(numPoints) + " points, offset, flip and rotation");
+	addResult("Per point checks : " + ofToString(oldtime/1000.0f/repeats, 3) + "ms");
+	addResult("Single transform : " + ofToString(newtime/1000.0f/repeats, 3) + "ms");
+	addResult("Max position difference : " + ofToString(maxdifference, 6) + " blanking differences : " + ofToString(colourdifferences));
+	addResult("");
+
+}
+
+void ofApp::benchmarkZoneAssignment() {
+
+	// changing the number of zones and the number of shapes separately
+	addResult("ZONE ASSIGNMENT");
+	for(int numZones : {1, 4, 16, 64}) {
+		timeZoneAssignment(numZones, 2000);
+	}
+	for(int numShapes : {500, 8000}) {
+		timeZoneAssignment(16, numShapes);
+	}
+	checkZoneGrid();
+	addResult("");
+
+}
+
+void ofApp::timeZoneAssignment(int numZones, int numShapes) {
+
+	int repeats = 20;
+
+	// the zones are tiled across the canvas
+	int across = ceil(sqrt((float)numZones));
+	float zonesize = 800.0f/across;
+	vector<ofRectangle> zonerects;
+	for(int i = 0; i<numZones; i++) {
+		zonerects.push_back(ofRectangle((i%across)*zonesize, (i/across)*zonesize, zonesize, zonesize));
+	}
+
+	// small wiggly lines all over the canvas
+	ofSeedRandom(4);
+	vector<std::unique_ptr<Polyline>> shapes;
+	ofPolyline poly;
+	for(int i = 0; i<numShapes; i++) {
+		poly.clear();
+		glm::vec3 p(ofRandom(0,800), ofRandom(0,800), 0);
+		for(int j = 0; j<10; j++) {
+			poly.addVertex(p);
+			p+=glm::vec3(ofRandom(-8,8), ofRandom(-8,8), 0);
+		}
+		shapes.emplace_back(new Polyline(poly, ofColor::white, OFXLASER_PROFILE_DEFAULT));
+	}
+
+	// every zone against every shape, like ManagerBase::send used to
+	int bruteforcecount = 0;
+	uint64_t starttime = ofGetElapsedTimeMicros();
+	for(int r = 0; r<repeats; r++) {
+		bruteforcecount = 0;
+		for(ofRectangle& rect : zonerects) {
+			for(auto& shape : shapes) {
+				if(shape->intersectsRect(rect)) bruteforcecount++;
+			}
+		}
+	}
+	float bruteforcetime = (ofGetElapsedTimeMicros()-starttime)/1000.0f/repeats;
+
+	ZoneGrid grid;
+	int gridcount = 0;
+	starttime = ofGetElapsedTimeMicros();
+	for(int r = 0; r<repeats; r++) {
+		gridcount = 0;
+		grid.update(zonerects, ofRectangle(0,0,800,800));
+		for(auto& shape : shapes) {
+			for(int j : grid.getZonesForRect(shape->getBoundingBox())) {
+				if(shape->intersectsRect(zonerects[j])) gridcount++;
+			}
+		}
+	}
+	float gridtime = (ofGetElapsedTimeMicros()-starttime)/1000.0f/repeats;
+
+	addResult(ofToString(numZones) + " zones, " + ofToString(numShapes) + " shapes : every zone " + ofToString(bruteforcetime, 3) + "ms, grid " + ofToString(gridtime, 3) + "ms" + ((gridcount==bruteforcecount) ? "" : " MISMATCH"));
+
+}
+
+void ofApp::checkZoneGrid() {
+
+	// random zones that overlap each other and go past the edges, checked
+	// against every zone for random rectangles. The grid can return extra
+	// zones but it must never miss one.
+	ofSeedRandom(7);
+	ofRectangle bounds(0,0,800,800);
+	ZoneGrid grid;
+	int missed = 0;
+	int unsorted = 0;
+	int numchecks = 0;
+	for(int test = 0; test<200; test++) {
+		vector<ofRectangle> zonerects;
+		int numZones = ofRandom(1, 40);
+		for(int i = 0; i<numZones; i++) {
+			zonerects.push_back(ofRectangle(ofRandom(-200,900), ofRandom(-200,900), ofRandom(0,400), ofRandom(0,400)));
+		}
+		grid.update(zonerects, bounds);
+
+		for(int i = 0; i<200; i++) {
+			ofRectangle rect(ofRandom(-300,1000), ofRandom(-300,1000), ofRandom(0,100), ofRandom(0,100));
+			const vector<int>& zones = grid.getZonesForRect(rect);
+			for(size_t j = 1; j<zones.size(); j++) {
+				if(zones[j]<=zones[j-1]) unsorted++;
+			}
+			for(int j = 0; j<numZones; j++) {
+				if(!zonerects[j].intersects(rect)) continue;
+				if(!std::binary_search(zones.begin(), zones.end(), j)) missed++;
+			}
+			numchecks++;
+		}
+	}
+	addResult("Grid against every zone, " + ofToString(numchecks) + " rectangles : " + (((missed==0) && (unsorted==0)) ? "OK" : ofToString(missed) + " missed, " + ofToString(unsorted) + " out of order"));
+
+}
+
+void ofApp::benchmarkZoneBalancing() {
+
+	// four lasers, each with a zone that covers most of the canvas so
+	// they all overlap in the middle. Most of the shapes are crowded into
+	// the top left.
+	int numLasers = 4;
+	int pps = 30000;
+	float targetFramerate = 25;
+	int numShapes = 300;
+
+	vector<ofRectangle> zonerects = {
+		ofRectangle(0,0,600,600), ofRectangle(200,0,600,600),
+		ofRectangle(0,200,600,600), ofRectangle(200,200,600,600)
+	};
+	vector<vector<int>> zonelasers = {{0}, {1}, {2}, {3}};
+	vector<float> budgets(numLasers, pps/targetFramerate);
+
+	ofSeedRandom(5);
+	vector<std::unique_ptr<Polyline>> shapes;
+	vector<Shape*> shapepointers;
+	ofPolyline poly;
+	for(int i = 0; i<numShapes; i++) {
+		poly.clear();
+		bool crowded = (i%4)!=0;
+		glm::vec3 p = crowded ? glm::vec3(ofRandom(220,380), ofRandom(220,380), 0) : glm::vec3(ofRandom(20,780), ofRandom(20,780), 0);
+		for(int j = 0; j<6; j++) {
+			poly.addVertex(p);
+			p+=glm::vec3(ofRandom(-6,6), ofRandom(-6,6), 0);
+		}
+		shapes.emplace_back(new Polyline(poly, ofColor::white, OFXLASER_PROFILE_DEFAULT));
+		shapepointers.push_back(shapes.back().get());
+	}
+
+	RenderProfile profile(OFXLASER_PROFILE_DEFAULT);
+	ZoneBalancer::PointEstimator estimator = [&](Shape& shape, int laserindex) -> float {
+		return Shape::getPointsAlongDistance(profile, shape.getLength(), 1)->size();
+	};
+
+	// automatic mode, every zone that the shape touches draws it
+	vector<float> automaticpoints(numLasers, 0);
+	for(Shape* shape : shapepointers) {
+		for(int j = 0; j<(int)zonerects.size(); j++) {
+			if(shape->intersectsRect(zonerects[j])) automaticpoints[zonelasers[j][0]] += estimator(*shape, zonelasers[j][0]);
+		}
+	}
+
+	ZoneBalancer balancer;
+	int repeats = 100;
+	uint64_t starttime = ofGetElapsedTimeMicros();
+	for(int r = 0; r<repeats; r++) {
+		balancer.setZones(zonerects, zonelasers);
+		balancer.setLaserBudgets(budgets);
+		balancer.assignShapes(shapepointers, estimator);
+	}
+	float balancetime = (ofGetElapsedTimeMicros()-starttime)/1000.0f/repeats;
+
+	addResult("ZONE BALANCING");
+	addResult(ofToString(numLasers) + " lasers with overlapping zones, " + ofToString(numShapes) + " shapes, " + ofToString(budgets[0]) + " points per frame");
+	string automaticresult = "Automatic : ";
+	string optimisedresult = "Optimised : ";
+	float automaticmin = targetFramerate;
+	float optimisedmin = targetFramerate;
+	for(int i = 0; i<numLasers; i++) {
+		float automaticfps = MIN(targetFramerate, pps/MAX(automaticpoints[i], 1.0f));
+		float optimisedfps = MIN(targetFramerate, pps/MAX(balancer.getPointsUsed(i), 1.0f));
+		automaticmin = MIN(automaticmin, automaticfps);
+		optimisedmin = MIN(optimisedmin, optimisedfps);
+		automaticresult += ofToString(automaticpoints[i], 0) + " ";
+		optimisedresult += ofToString(balancer.getPointsUsed(i), 0) + " ";
+	}
+	addResult(automaticresult + "points, lowest " + ofToString(automaticmin, 1) + "fps");
+	addResult(optimisedresult + "points, lowest " + ofToString(optimisedmin, 1) + "fps");
+	addResult("Balancing time : " + ofToString(balancetime, 3) + "ms");
+	addResult("");
+
+}
+
+void ofApp::benchmarkEtherdream() {
+
+	// the real DacEtherdream talking to a pretend etherdream on this
+	// computer, with different amounts of network latency
+	addResult("ETHERDREAM");
+	DacEtherdreamEmulator emulator;
+	if(!emulator.setup("127.0.0.1")) {
+		addResult("Couldn't start the emulator, is something else using port 7765?");
+		addResult("");
+		return;
+	}
+	timeEtherdream(emulator, 0, 0, false);
+	timeEtherdream(emulator, 0, 0, true);
+	timeEtherdream(emulator, 2000, 1000, true);
+	timeEtherdream(emulator, 10000, 5000, true);
+	emulator.close();
+	addResult("");
+
+}
+
+void ofApp::timeEtherdream(DacEtherdreamEmulator& emulator, int latencymicros, int jittermicros, bool adaptive) {
+
+	int pps = 30000;
+	int numPoints = 600; // 50 frames a second
+	float seconds = 3;
+
+	vector<Point> points(numPoints);
+	for(int i = 0; i<numPoints; i++) {
+		float angle = ofMap(i, 0, numPoints, 0, TWO_PI);
+		points[i] = Point(glm::vec3(400+(cos(angle)*300), 400+(sin(angle)*300), 0), ofColor::white);
+	}
+
+	emulator.setNetworkLatency(latencymicros, jittermicros);
+	DacEtherdream dac;
+	dac.adaptiveLatency = adaptive;
+	dac.setPointsPerSecond(pps);
+	dac.setup("emulator", "127.0.0.1");
+
+	// give it a moment to start playing
+	dac.sendFrame(points);
+	ofSleepMillis(500);
+	emulator.resetStats();
+
+	uint64_t starttime = ofGetElapsedTimeMicros();
+	int outputlatency = 0;
+	int numframes = 0;
+	while(ofGetElapsedTimeMicros()-starttime<seconds*1000000) {
+		dac.sendFrame(points);
+		outputlatency += dac.getOutputLatencyMicros();
+		numframes++;
+		ofSleepMillis(1000*numPoints/pps);
+	}
+	float elapsed = (ofGetElapsedTimeMicros()-starttime)/1000000.0f;
+	EtherdreamEmulatorStats stats = emulator.getStats();
+	dac.close();
+
+	string label = "Latency " + ofToString(latencymicros/1000.0f, 1) + "ms +/- " + ofToString(jittermicros/1000.0f, 1) + "ms, " + (adaptive ? "adaptive" : "fixed") + " buffer";
+	addResult(label);
+	addResult("  Points played : " + ofToString(stats.pointsPlayed/elapsed, 0) + " per second of " + ofToString(pps));
+	addResult("  Underflows : " + ofToString(stats.underflowCount) + ", lowest buffer " + ofToString(stats.lowestFullness) + " points, " + ofToString(dac.getBlankPointCount()) + " blank points added");
+	addResult("  Data commands : " + ofToString(stats.dataCommandCount/elapsed, 0) + " per second, round trip " + ofToString(dac.getCommandLatencyMicros('d')/1000.0f, 2) + "ms");
+	addResult("  Output latency : " + ofToString(outputlatency/1000.0f/MAX(numframes, 1), 1) + "ms, buffer " + ofToString(dac.dacBufferSize) + " points");
+
+}
+
+void ofApp::benchmarkIDN() {
+
+	// sends IDN frames as fast as possible to a socket on this computer
+	// that just counts what arrives
+	addResult("IDN");
+	int port = 17255;
+	timeIDN(1500, false, port);
+	timeIDN(1500, true, port);
+	timeIDN(9000, false, port);
+	timeIDN(9000, true, port);
+	addResult("");
+
+}
+
+void ofApp::timeIDN(int mtu, bool batch, int port) {
+
+	int pps = 30000;
+	int numPoints = 2000;
+	float seconds = 1;
+
+	vector<IDN_point> points(numPoints);
+	for(int i = 0; i<numPoints; i++) {
+		float angle = ofMap(i, 0, numPoints, 0, TWO_PI);
+		points[i].x = (int16_t)(cos(angle)*30000);
+		points[i].y = (int16_t)(sin(angle)*30000);
+		points[i].r = points[i].g = points[i].b = 255;
+	}
+
+	Poco::Net::DatagramSocket sink;
+	try {
+		sink.bind(Poco::Net::SocketAddress("127.0.0.1", port), true);
+		sink.setReceiveBufferSize(4*1024*1024);
+		sink.setReceiveTimeout(Poco::Timespan(0, 100000));
+	} catch (Poco::Exception& exc) {
+		addResult("Couldn't open the UDP sink on port " + ofToString(port) + " : " + exc.displayText());
+		return;
+	}
+	std::atomic<bool> receiving(true);
+	std::atomic<uint64_t> packetsReceived(0);
+	std::thread sinkThread([&]() {
+		vector<uint8_t> buffer(65536);
+		while(receiving) {
+			try {
+				if(sink.receiveBytes(buffer.data(), buffer.size())>0) packetsReceived++;
+			} catch (Poco::TimeoutException&) {
+			} catch (Poco::Exception&) {
+				break;
+			}
+		}
+	});
+
+	IDNPacketSender sender;
+	sender.setMtu(mtu);
+	sender.batchSend = batch;
+	sender.setup("127.0.0.1", port);
+
+	uint64_t buildtime = 0;
+	int numframes = 0;
+	uint64_t starttime = ofGetElapsedTimeMicros();
+	while(ofGetElapsedTimeMicros()-starttime<seconds*1000000) {
+		uint64_t buildstart = ofGetElapsedTimeMicros();
+		sender.buildPackets(points.data(), points.size(), pps);
+		buildtime += ofGetElapsedTimeMicros()-buildstart;
+		sender.sendPackets();
+		numframes++;
+		// don't let it get too far ahead of the sink
+		if(numframes%20==0) ofSleepMillis(1);
+	}
+	float elapsed = (ofGetElapsedTimeMicros()-starttime)/1000000.0f;
+
+	// let the last few arrive
+	ofSleepMillis(200);
+	receiving = false;
+	sinkThread.join();
+	sink.close();
+	sender.close();
+
+	uint64_t packetssent = sender.getPacketsSent();
+	addResult("MTU " + ofToString(mtu) + ", " + (batch ? "batched" : "one at a time") + ", " + ofToString(sender.getNumPackets()) + " packets per " + ofToString(numPoints) + " point frame");
+	addResult("  " + ofToString(numframes/elapsed, 0) + " frames per second, " + ofToString(packetssent/elapsed, 0) + " packets per second, " + ofToString(sender.getBytesSent()/elapsed/1000000.0f, 1) + "MB/s");
+	addResult("  Build : " + ofToString((float)buildtime/MAX(numframes, 1), 2) + "us per frame, received " + ofToString(100.0f*packetsReceived/MAX(packetssent, (uint64_t)1), 1) + "%");
+
+}
+
+void ofApp::addResult(string result) {
+	ofLogNotice("ofxLaser benchmark") << result;
+	results.push_back(result);
+}
+
+//--------------------------------------------------------------
+void ofApp::keyPressed(ofKeyEventArgs& e){
+	if(e.key==' ') runBenchmarks();
+}
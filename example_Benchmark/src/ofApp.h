@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ofMain.h"
+#include "constants.h"
+#include "ofxLaserZoneTransform.h"
+#include "ofxLaserOutputTransform.h"
+#include "ofxLaserPolyline.h"
+#include "ofxLaserZoneGrid.h"
+#include "ofxLaserZoneBalancer.h"
+#include "ofxLaserDacEtherdreamEmulator.h"
+#include "ofxLaserDacIDNPacketSender.h"
+#include "ofxLaserRenderThreadPool.h"
+
+// Times some of the slower parts of ofxLaser so that we can check
+// optimisations are actually making a difference. The results are
+// printed to the console and shown in the window. Press space to
+// run them again.
+
+class ofApp : public ofBaseApp{
+
+public:
+	void setup();
+	void update();
+	void draw();
+
+	void keyPressed(ofKeyEventArgs& e);
+
+	void runBenchmarks();
+	// checks the thread pool doesn't hang when it's run as soon as the
+	// threads are made
+	void checkRenderThreadPool();
+	void benchmarkWarpUpdate();
+	void benchmarkOutputTransform();
+	void benchmarkZoneAssignment();
+	void timeZoneAssignment(int numZones, int numShapes);
+	// checks the ZoneGrid never leaves out a zone that overlaps
+	void checkZoneGrid();
+	void benchmarkZoneBalancing();
+	void benchmarkEtherdream();
+	void timeEtherdream(ofxLaser::DacEtherdreamEmulator& emulator, int latencymicros, int jittermicros, bool adaptive);
+	void benchmarkIDN();
+	void timeIDN(int mtu, bool batch, int port);
+
+	void addResult(string result);
+
+	vector<string> results;
+
+};
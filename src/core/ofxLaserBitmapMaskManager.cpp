@@ -23,7 +23,6 @@ BitmapMaskManager ::BitmapMaskManager() {
 
 BitmapMaskManager ::~BitmapMaskManager() {
     
-    if(fbo.isAllocated()) fbo.clear();
     while(quads.size()>0) {
         delete quads.back();
         quads.pop_back();
@@ -35,48 +34,135 @@ bool BitmapMaskManager ::update() {
     bool isdirty = MaskManager::update();
     
     firstUpdate = false;
-    if(isdirty) {
-        fbo.begin();
-		ofDisableBlendMode();
-        ofBackground(255);
-//		if(maskBitmap.isAllocated()) {
-//			maskBitmap.draw(0,0,width, height);
-//		}
-       
-        ofFill();
-        
-        for(int i = 0; i<quads.size(); i++) {
-            QuadMask& quad = *quads[i];
-            
-            ofSetColor(255*(1.0f-quad.maskLevel));
-            
-            ofBeginShape();
-            
-            ofVertex(quad.handles[0]);
-            ofVertex(quad.handles[1]);
-            ofVertex(quad.handles[3]);
-            ofVertex(quad.handles[2]);
-            ofEndShape();
+    
+    // the quad dirty flags get cleared when they're drawn so we keep a
+    // copy of each quad and redraw the area around any that have changed
+    ofRectangle dirtyRect;
+    bool changed = false;
+    size_t numQuads = MAX(quads.size(), quadStates.size());
+    for(size_t i = 0; i<numQuads; i++) {
+        if(i>=quads.size()) {
+            // quad has been deleted
+            dirtyRect = changed ? dirtyRect.getUnion(quadStates[i].bounds) : quadStates[i].bounds;
+            changed = true;
+            continue;
         }
-        
-        
-        fbo.end();
-        fbo.readToPixels(pixels);
-        //saveSettings();
+        QuadState state = getQuadState(*quads[i]);
+        if(i<quadStates.size()) {
+            QuadState& last = quadStates[i];
+            bool same = (state.level==last.level);
+            for(int j = 0; j<4; j++) same &= (state.corners[j]==last.corners[j]);
+            if(same) continue;
+            dirtyRect = changed ? dirtyRect.getUnion(last.bounds) : last.bounds;
+            changed = true;
+        }
+        dirtyRect = changed ? dirtyRect.getUnion(state.bounds) : state.bounds;
+        changed = true;
+    }
+    
+    if(changed) {
+        quadStates.resize(quads.size());
+        for(size_t i = 0; i<quads.size(); i++) {
+            quadStates[i] = getQuadState(*quads[i]);
+        }
+        // a pixel is filled if its centre is inside the quad so add a
+        // pixel all round to be safe
+        rasterise(floor(dirtyRect.getLeft())-1, floor(dirtyRect.getTop())-1, ceil(dirtyRect.getRight())+1, ceil(dirtyRect.getBottom())+1);
+        isdirty = true;
     }
     return isdirty;
 }
 
+BitmapMaskManager::QuadState BitmapMaskManager :: getQuadState(QuadMask& quad) {
+    QuadState state;
+    // same order as they're drawn in
+    state.corners[0] = glm::vec2(quad.handles[0].x, quad.handles[0].y);
+    state.corners[1] = glm::vec2(quad.handles[1].x, quad.handles[1].y);
+    state.corners[2] = glm::vec2(quad.handles[3].x, quad.handles[3].y);
+    state.corners[3] = glm::vec2(quad.handles[2].x, quad.handles[2].y);
+    state.level = ofClamp(1.0f-(quad.maskLevel/100.0f), 0, 1);
+    
+    glm::vec2 topleft = state.corners[0];
+    glm::vec2 bottomright = state.corners[0];
+    for(int i = 1; i<4; i++) {
+        topleft = glm::min(topleft, state.corners[i]);
+        bottomright = glm::max(bottomright, state.corners[i]);
+    }
+    state.bounds.set(topleft.x, topleft.y, bottomright.x-topleft.x, bottomright.y-topleft.y);
+    return state;
+}
+
+void BitmapMaskManager :: rasterise(int left, int top, int right, int bottom) {
+    
+    if(brightnessMap.size()!=(size_t)(width*height)) return;
+    
+    left = MAX(left, 0);
+    top = MAX(top, 0);
+    right = MIN(right, width);
+    bottom = MIN(bottom, height);
+    if((left>=right) || (top>=bottom)) return;
+    
+    for(int y = top; y<bottom; y++) {
+        std::fill(brightnessMap.begin()+(y*width)+left, brightnessMap.begin()+(y*width)+right, 1.0f);
+    }
+    
+    // later quads are drawn over the top of earlier ones
+    for(QuadState& quad : quadStates) {
+        fillQuad(quad, left, top, right, bottom);
+    }
+    
+    // and update the preview image
+    unsigned char* data = pixels.getData();
+    for(int y = top; y<bottom; y++) {
+        for(int x = left; x<right; x++) {
+            data[(y*width)+x] = round(brightnessMap[(y*width)+x]*255);
+        }
+    }
+    textureDirty = true;
+    
+}
+
+void BitmapMaskManager :: fillQuad(const QuadState& quad, int left, int top, int right, int bottom) {
+    
+    int firstrow = MAX(top, (int)floor(quad.bounds.getTop()));
+    int lastrow = MIN(bottom-1, (int)ceil(quad.bounds.getBottom()));
+    
+    // fill each row between pairs of edge crossings (even-odd rule, same as
+    // ofBeginShape), a pixel is inside if its centre is
+    for(int y = firstrow; y<=lastrow; y++) {
+        float centrey = y+0.5f;
+        crossings.clear();
+        for(int i = 0; i<4; i++) {
+            const glm::vec2& a = quad.corners[i];
+            const glm::vec2& b = quad.corners[(i+1)%4];
+            if((a.y<=centrey) == (b.y<=centrey)) continue;
+            crossings.push_back(a.x + ((centrey-a.y)/(b.y-a.y))*(b.x-a.x));
+        }
+        std::sort(crossings.begin(), crossings.end());
+        
+        float* row = brightnessMap.data() + (y*width);
+        for(size_t i = 0; i+1<crossings.size(); i+=2) {
+            int startx = MAX(left, (int)ceil(crossings[i]-0.5f));
+            int endx = MIN(right, (int)ceil(crossings[i+1]-0.5f));
+            for(int x = startx; x<endx; x++) row[x] = quad.level;
+        }
+    }
+}
+
 bool BitmapMaskManager ::draw(bool showBitmap) {
     
     if(showBitmap) {
+        if(textureDirty && pixels.isAllocated()) {
+            texture.loadData(pixels);
+            textureDirty = false;
+        }
         ofPushStyle();
 		ofPushMatrix();
 		ofTranslate(offset);
 		ofScale(scale, scale);
         ofEnableBlendMode(OF_BLENDMODE_ADD);
         ofSetColor(50,0,0);
-        fbo.draw(0,0);
+        if(texture.isAllocated()) texture.draw(0,0);
         
         ofPopStyle();
 		ofPopMatrix();
@@ -101,28 +187,66 @@ void BitmapMaskManager ::init(int w, int h){
 //		maskBitmap.allocate(width, height, OF_IMAGE_COLOR);
 //	};
 	
-    if(fbo.isAllocated()) {
-        fbo.clear();
-    }
-    
-    fbo.allocate(width, height, GL_RGB);
+    // everything is rasterised on the CPU so there's no need for an fbo
+    // (or a GL context)
+    brightnessMap.assign(width*height, 1.0f);
+    pixels.allocate(width, height, OF_PIXELS_GRAY);
+    pixels.set(255);
+    textureDirty = true;
     
-    fbo.begin();
-    ofBackground(255);
-//	if(maskBitmap.isAllocated()) {
-//		maskBitmap.draw(0,0,w,h);
-//	}
-    fbo.end();
-    fbo.readToPixels(pixels);
+    // draw all the quads again
+    quadStates.clear();
     
 }
 
 
 float BitmapMaskManager ::getBrightness(int x, int y) {
-    ofFloatColor c = pixels.getColor(x,y);
-    return c.getBrightness();
+    if((x<0) || (y<0) || (x>=width) || (y>=height)) return 0;
+    return brightnessMap[(y*width)+x];
     
 }
+
+float BitmapMaskManager ::getBrightnessBilinear(float x, float y) {
+    
+    // pixel centres are at +0.5
+    x-=0.5f;
+    y-=0.5f;
+    float fx = floor(x);
+    float fy = floor(y);
+    int x1 = fx;
+    int y1 = fy;
+    float u = x-fx;
+    float v = y-fy;
+    
+    float top = ofLerp(getBrightness(x1, y1), getBrightness(x1+1, y1), u);
+    float bottom = ofLerp(getBrightness(x1, y1+1), getBrightness(x1+1, y1+1), u);
+    return ofLerp(top, bottom, v);
+}
+
+void BitmapMaskManager ::applyBrightness(Point* points, size_t count) {
+    
+    if(brightnessMap.empty()) return;
+    
+    if(smoothSampling) {
+        for(size_t i = 0; i<count; i++) {
+            Point& p = points[i];
+            float brightness = getBrightnessBilinear(p.x, p.y);
+            p.r*=brightness;
+            p.g*=brightness;
+            p.b*=brightness;
+        }
+    } else {
+        for(size_t i = 0; i<count; i++) {
+            Point& p = points[i];
+            // same as truncating the coordinates in ofPixels::getColor
+            float brightness = getBrightness((int)p.x, (int)p.y);
+            p.r*=brightness;
+            p.g*=brightness;
+            p.b*=brightness;
+        }
+    }
+}
+
 ofPixels* BitmapMaskManager ::getPixels() {
     return &pixels;
 }
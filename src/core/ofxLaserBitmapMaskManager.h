@@ -23,8 +23,21 @@ public:
     virtual bool update() override;
     virtual bool draw(bool showBitmap = false);
     
+    // a grayscale copy of the mask, only used for drawing now
     ofPixels* getPixels();
+    // brightness of the mask at a pixel, 0 if it's outside
     float getBrightness(int x, int y);
+    // interpolates between the four nearest pixel centres
+    float getBrightnessBilinear(float x, float y);
+    
+    // multiplies the colour of each point by the mask brightness
+    // at its position
+    void applyBrightness(Point* points, size_t count);
+    
+    // use bilinear sampling in applyBrightness rather than the nearest
+    // pixel, gives a smooth fade at the edge of the masks
+    bool smoothSampling = false;
+    
 //    bool loadSettings();
 //    bool saveSettings();
 //	void setOffsetAndScale(ofPoint offset, float scale);
@@ -34,7 +47,6 @@ public:
 //
 //    vector<QuadMask*> quads;
 //
-    ofFbo fbo;
     ofPixels pixels;
 	//ofImage maskBitmap;
 //	int width, height;
@@ -45,5 +57,29 @@ public:
 //	float scale = 1;
     bool firstUpdate = true;
     
+    protected :
+    
+    // the parts of a quad that affect the mask, so we can see what's changed
+    struct QuadState {
+        glm::vec2 corners[4];
+        float level;
+        ofRectangle bounds;
+    };
+    QuadState getQuadState(QuadMask& quad);
+    
+    // clears then redraws all the quads into this part of the mask
+    void rasterise(int left, int top, int right, int bottom);
+    void fillQuad(const QuadState& quad, int left, int top, int right, int bottom);
+    
+    // one float per pixel, 1 is full brightness
+    vector<float> brightnessMap;
+    vector<QuadState> quadStates;
+    
+    ofTexture texture;
+    bool textureDirty = true;
+    
+    // temp storage for the scanline crossings
+    vector<float> crossings;
+    
 };
 }
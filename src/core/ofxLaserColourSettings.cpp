@@ -30,6 +30,7 @@ ColourSettings :: ColourSettings(){
     params.add(blue25.set("blue 25", 0.25,0,1));
     params.add(blue0.set("blue 0", 0,0,1));
     
+    params.add(smoothCurve.set("Smooth calibration curve", false));
     
 };
 float ColourSettings::calculateCalibratedBrightness(float value, float intensity, float level100, float level75, float level50, float level25, float level0){
@@ -49,8 +50,96 @@ float ColourSettings::calculateCalibratedBrightness(float value, float intensity
     
 }
 
+float ColourSettings::calculateSmoothCalibratedBrightness(float value, float intensity, float level100, float level75, float level50, float level25, float level0){
+    value/=255.0f;
+    value *=intensity;
+    if(value<0.001) return 0;
+    float levels[5] = {level0, level25, level50, level75, level100};
+    return getCalibratedLevel(value, levels, true)*255;
+}
+
+// value is 0 to 1, levels are the outputs at 0, 25, 50, 75 and 100%
+// brightness, each one 0 to 1 like the parameters
+float ColourSettings::getCalibratedLevel(float value, const float* levels, bool smooth) {
+    
+    // which quarter we're in, the last one carries on past 1
+    int segment = ofClamp((int)(value*4), 0, 3);
+    
+    if(!smooth) {
+        return ofMap(value, segment*0.25f, (segment+1)*0.25f, levels[segment], levels[segment+1]);
+    }
+    
+    value = MIN(value, 1);
+    
+    // monotonic cubic through the five levels (Fritsch-Carlson) so it
+    // doesn't overshoot between them
+    float slopes[4];
+    for(int i = 0; i<4; i++) slopes[i] = (levels[i+1]-levels[i])*4;
+    float tangents[5];
+    tangents[0] = slopes[0];
+    tangents[4] = slopes[3];
+    for(int i = 1; i<4; i++) {
+        if(slopes[i-1]*slopes[i]<=0) tangents[i] = 0;
+        else tangents[i] = 2.0f/((1.0f/slopes[i-1]) + (1.0f/slopes[i]));
+    }
+    
+    float t = (value*4)-segment;
+    float t2 = t*t;
+    float t3 = t2*t;
+    float h00 = (2*t3) - (3*t2) + 1;
+    float h10 = t3 - (2*t2) + t;
+    float h01 = (-2*t3) + (3*t2);
+    float h11 = t3 - t2;
+    return (h00*levels[segment]) + (h10*0.25f*tangents[segment]) + (h01*levels[segment+1]) + (h11*0.25f*tangents[segment+1]);
+    
+}
+
+void ColourSettings::updateLookupTables(float brightness) {
+    
+    // reading ofParameters isn't free so check them all once here rather
+    // than for every point
+    newTableSettings = {brightness, (float)smoothCurve,
+        red100, red75, red50, red25, red0,
+        green100, green75, green50, green25, green0,
+        blue100, blue75, blue50, blue25, blue0};
+    if(newTableSettings==tableSettings) return;
+    tableSettings.swap(newTableSettings);
+    
+    // same cut off as calculateCalibratedBrightness
+    blackThreshold = (brightness>0) ? (0.001f*255.0f)/brightness : INFINITY;
+    
+    float redLevels[5] = {red0, red25, red50, red75, red100};
+    float greenLevels[5] = {green0, green25, green50, green75, green100};
+    float blueLevels[5] = {blue0, blue25, blue50, blue75, blue100};
+    bool smooth = smoothCurve;
+    
+    // one extra entry so the interpolation can always look at the next one
+    redTable.resize(lookupTableSize+1);
+    greenTable.resize(lookupTableSize+1);
+    blueTable.resize(lookupTableSize+1);
+    
+    for(int i = 0; i<=lookupTableSize; i++) {
+        float value = (MIN(i, lookupTableSize-1)/lookupTableScale)/255.0f*brightness;
+        redTable[i] = getCalibratedLevel(value, redLevels, smooth)*255;
+        greenTable[i] = getCalibratedLevel(value, greenLevels, smooth)*255;
+        blueTable[i] = getCalibratedLevel(value, blueLevels, smooth)*255;
+    }
+}
+
 void ColourSettings::processColour(ofxLaser::Point& p, float brightness) {
-    p.r = calculateCalibratedBrightness(p.r, brightness, red100, red75, red50, red25, red0);
-    p.g = calculateCalibratedBrightness(p.g, brightness, green100, green75, green50, green25, green0);
-    p.b = calculateCalibratedBrightness(p.b, brightness, blue100, blue75, blue50, blue25, blue0);
+    updateLookupTables(brightness);
+    p.r = lookUp(redTable, p.r);
+    p.g = lookUp(greenTable, p.g);
+    p.b = lookUp(blueTable, p.b);
+}
+
+void ColourSettings::processColours(ofxLaser::Point* points, size_t count, float brightness) {
+    updateLookupTables(brightness);
+    for(size_t i = 0; i<count; i++) {
+        Point& p = points[i];
+        if(!p.useCalibration) continue;
+        p.r = lookUp(redTable, p.r);
+        p.g = lookUp(greenTable, p.g);
+        p.b = lookUp(blueTable, p.b);
+    }
 }
@@ -18,7 +18,16 @@ class ColourSettings {
     ColourSettings();
     
     float calculateCalibratedBrightness(float value, float intensity, float level100, float level75, float level50, float level25, float level0);
+    // same but with a smooth curve through the levels rather than
+    // straight lines between them
+    float calculateSmoothCalibratedBrightness(float value, float intensity, float level100, float level75, float level50, float level25, float level0);
+    
     void processColour(ofxLaser::Point& p, float brightness);
+    // calibrates all the points that use calibration
+    void processColours(ofxLaser::Point* points, size_t count, float brightness);
+    
+    // the number of entries in each of the lookup tables
+    static const int lookupTableSize = 4096;
     
     // would probably be sensible to move these settings out into a colour
     // calibration object.
@@ -42,5 +51,35 @@ class ColourSettings {
     ofParameter<float>blue25;
     ofParameter<float>blue0;
     
+    ofParameter<bool>smoothCurve;
+    
+    protected :
+    
+    // the calibration curves are baked into a lookup table for each
+    // colour, including the brightness. They're only rebuilt if any of
+    // the settings or the brightness change.
+    void updateLookupTables(float brightness);
+    inline float lookUp(const vector<float>& table, float value) {
+        // anything this dark is switched off completely. The tables don't
+        // include the cut off so that the interpolation isn't affected by it.
+        // (written this way round so that NaN is switched off too)
+        if(!(value>=blackThreshold)) return 0;
+        // value is 0 to 255, linear interpolation between the entries
+        float index = MIN(value*lookupTableScale, lookupTableSize-1);
+        int i = (int)index;
+        float fraction = index-i;
+        return table[i] + ((table[i+1]-table[i])*fraction);
+    }
+    
+    static float getCalibratedLevel(float value, const float* levels, bool smooth);
+    
+    vector<float> redTable, greenTable, blueTable;
+    float lookupTableScale = (lookupTableSize-1)/255.0f;
+    float blackThreshold = 0;
+    
+    // the settings that the tables were made with
+    vector<float> tableSettings;
+    vector<float> newTableSettings;
+    
 };
 }
@@ -390,11 +390,8 @@ void Graphic::subtractPolyline(ofPolyline* polyToSubtract, bool useTransform) {
 }
 
 void Graphic :: transformPolyline(ofPolyline& poly) {
-	vector<glm::vec3>& newPolyVerts = poly.getVertices();
-
-	for(size_t i= 0; i<newPolyVerts.size(); i++) {
-		newPolyVerts[i]=gLProject(newPolyVerts[i]);
-	}
+	screenProjection.update();
+	screenProjection.project(poly.getVertices());
 	
 }
 
@@ -413,26 +410,8 @@ ofPath Graphic :: transformPath(ofPath& path) {
 }
 glm::vec3 Graphic::gLProject(glm::vec3& v) {
 
-	ofRectangle rViewport = ofGetCurrentViewport();
-	
-	glm::mat4 modelview, projection;
-	glGetFloatv(GL_MODELVIEW_MATRIX, glm::value_ptr(modelview));
-	glGetFloatv(GL_PROJECTION_MATRIX, glm::value_ptr(projection));
-	glm::mat4 mat = ofGetCurrentOrientationMatrix();
-	mat = glm::inverse(mat);
-	mat *=projection * modelview;
-	glm::vec4 dScreen4 = mat * glm::vec4(v.x,v.y,v.z,1.0);
-	glm::vec3 dScreen = glm::vec3(dScreen4) / dScreen4.w;
-	dScreen += glm::vec3(1.0) ;
-	dScreen *= 0.5;
-	
-	dScreen.x *= rViewport.width;
-	dScreen.x += rViewport.x;
-	
-	dScreen.y *= rViewport.height;
-	dScreen.y += rViewport.y;
-	
-	return ofPoint(dScreen.x, dScreen.y, 0.0f);
+	screenProjection.update();
+	return screenProjection.project(v);
 }
 
 void Graphic ::  connectLineSegments() {
@@ -10,6 +10,7 @@
 //#include "ofxLaserManagerBase.h"
 #include "ofxClipper.h"
 #include "ofxLaserFactory.h"
+#include "ofxLaserScreenProjection.h"
 #include "ofxSvgExtra.h"
 
 namespace ofxLaser {
@@ -116,6 +117,7 @@ class Graphic {
 	vector<ofPolyline> polylineMask;
 	
 	ofx::Clipper clipper;
+	ScreenProjection screenProjection;
 	
 	//object factory for ofPolylines!
 
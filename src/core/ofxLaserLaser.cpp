@@ -20,6 +20,8 @@ Laser::Laser(int _index) {
  	
 	guiInitialised = false;
     maskManager.init(800,800);
+    
+    std::fill(colourDelayBuffer, colourDelayBuffer+colourDelayBufferSize, glm::vec3(0));
    
     
 	
@@ -69,6 +71,12 @@ bool Laser::removeDac(){
 int Laser::getPointRate() {
     return pps;
 };
+float Laser::getPointBudget() {
+    return (float)pps/targetFramerate;
+}
+float Laser::getPointEstimate(Shape& shape) {
+    return shape.getPointEstimate(getRenderProfile(shape.profileLabel), speedMultiplier);
+}
 float Laser::getFrameRate() {
     if(numPoints>0) return (float)pps/(float)numPoints;
     else return pps;
@@ -118,6 +126,8 @@ void Laser :: init() {
 	advanced.add(smoothHomePosition.set("Smooth home position", true));
     advanced.add(sortShapes.set("Optimise shape draw order", true));
     advanced.add(newShapeSortMethod.set("Experimental shape sorting", true));
+    advanced.add(spatialShapeSort.set("Fast spatial shape sorting", false));
+    advanced.add(reuseShapeOrder.set("Reuse shape order between frames", false));
     //advanced.add(alwaysClockwise.set("Always clockwise sorting", true));
     advanced.add(targetFramerate.set("Target framerate", 25, 23, 120));
 	advanced.add(syncToTargetFramerate.set("Sync to Target framerate", false));
@@ -608,7 +618,12 @@ void Laser::sendRawPoints(const vector<ofxLaser::Point>& points, Zone* zone, flo
 
                         
 
-void Laser::send(ofPixels* pixels, float masterIntensity) {
+void Laser::send(BitmapMaskManager* bitmapMask, float masterIntensity) {
+	render(bitmapMask, masterIntensity);
+	sendRenderedFrame();
+}
+
+void Laser::render(BitmapMaskManager* bitmapMask, float masterIntensity) {
 
 
 	if(!guiInitialised) {
@@ -616,12 +631,16 @@ void Laser::send(ofPixels* pixels, float masterIntensity) {
 		return;
 	}
 	
-	vector<PointsForShape> allzoneshapes;
+	uint64_t renderStartTime = ofGetElapsedTimeMicros();
+	
+	// these are kept between frames to avoid allocations
+	vector<PointsForShape>& allzoneshapes = shapeSegments;
+	vector<PointsForShape*>& sortedshapes = sortedShapeSegments;
+	sortedshapes.clear();
 
 	// TODO add speed multiplier to getPointsForMove function
-	getAllShapePoints(&allzoneshapes, pixels, speedMultiplier);
+	getAllShapePoints(&allzoneshapes, bitmapMask, speedMultiplier);
 	
-	vector<PointsForShape*> sortedshapes;
 	
 	
 	// sort the point objects
@@ -634,133 +653,147 @@ void Laser::send(ofPixels* pixels, float masterIntensity) {
         ofPoint position = laserHomePosition;
 
 
-		if(sortShapes) {
+        uint64_t sortStartTime = ofGetElapsedTimeMicros();
+        
+		if(sortShapes && reuseShapeOrder && shapeOrderCache.getOrder(allzoneshapes, sortedshapes, glm::vec2(laserHomePosition.x, laserHomePosition.y))) {
+            
+            // the shapes are the same as last frame (or close enough)
+            // so we can skip the sort
+            blankMoveDistance = getMoveDistanceForShapes(sortedshapes);
+            
+		} else if(sortShapes) {
             
             float moveDistanceForUnSortedShapes = getMoveDistanceForShapes(allzoneshapes);
             
-			do {
+            if(spatialShapeSort) {
+                shapeSorter.sortShapes(allzoneshapes, sortedshapes, glm::vec2(laserHomePosition.x, laserHomePosition.y));
+                
+            } else {
                 
-                if(currentShape!=nullptr) {
-                    // get the shape object at the current index
-                    PointsForShape& shape1 = *currentShape; // allzoneshapes[currentIndex];
+				do {
+                
+                    if(currentShape!=nullptr) {
+                        // get the shape object at the current index
+                        PointsForShape& shape1 = *currentShape; // allzoneshapes[currentIndex];
 				
-                    // set its tested flag to say we've checked it
-                    shape1.tested = true;
-                    // add it to the list
-                    sortedshapes.push_back(&shape1);
-                    // set its reversed flag - this is set during the
-                    // previous iterative process to find the next shape
-                    shape1.reversed = reversed;
+                        // set its tested flag to say we've checked it
+                        shape1.tested = true;
+                        // add it to the list
+                        sortedshapes.push_back(&shape1);
+                        // set its reversed flag - this is set during the
+                        // previous iterative process to find the next shape
+                        shape1.reversed = reversed;
                     
-                    position = shape1.getEnd();
+                        position = shape1.getEnd();
                     
-                    // set the distance to infinity
-                    shortestDistance = INFINITY;
-                    // reset the next shape in case we don't find any
-                    nextShape = nullptr;
-                }
+                        // set the distance to infinity
+                        shortestDistance = INFINITY;
+                        // reset the next shape in case we don't find any
+                        nextShape = nullptr;
+                    }
                     
 				
-                // go through all the shapes
-				for(size_t i = 0; i<allzoneshapes.size(); i++) {
+                    // go through all the shapes
+					for(size_t i = 0; i<allzoneshapes.size(); i++) {
 					
-                    // get the shape at j
-					PointsForShape& shape2 = allzoneshapes[i];
-					// if it's the same shape as this one or we've already checked it skip this one
-                    if((currentShape==&shape2) || (shape2.tested)) continue;
+                        // get the shape at j
+						PointsForShape& shape2 = allzoneshapes[i];
+						// if it's the same shape as this one or we've already checked it skip this one
+                        if((currentShape==&shape2) || (shape2.tested)) continue;
 					
-                    // check non-reversed first
-					shape2.reversed = false;
+                        // check non-reversed first
+						shape2.reversed = false;
 					
-                    // if the distance between our first shape and the second shape is
-                    // the shortest we've found...
-					if(position.squareDistance(shape2.getStart()) < shortestDistance) {
-                        // set the new shortest distance...
-						shortestDistance = position.squareDistance(shape2.getStart());
-                        // set this as the next shape to check
-						nextShape = &shape2;
-                        // set reversed to be false (this is set the next time around
-						reversed = false;
-					}
+                        // if the distance between our first shape and the second shape is
+                        // the shortest we've found...
+						if(position.squareDistance(shape2.getStart()) < shortestDistance) {
+                            // set the new shortest distance...
+							shortestDistance = position.squareDistance(shape2.getStart());
+                            // set this as the next shape to check
+							nextShape = &shape2;
+                            // set reversed to be false (this is set the next time around
+							reversed = false;
+						}
 					
-                    // now do the same thing but with the next shape reversed
-					if((shape2.reversable) && (position.squareDistance(shape2.getEnd()) < shortestDistance)) {
-						shortestDistance = position.squareDistance(shape2.getEnd());
-                        nextShape = &shape2;
-						reversed = true;
-					}
+                        // now do the same thing but with the next shape reversed
+						if((shape2.reversable) && (position.squareDistance(shape2.getEnd()) < shortestDistance)) {
+							shortestDistance = position.squareDistance(shape2.getEnd());
+                            nextShape = &shape2;
+							reversed = true;
+						}
 					
-				}
-                currentShape = nextShape;
+					}
+                    currentShape = nextShape;
 				
-			} while (currentShape!=nullptr);
+				} while (currentShape!=nullptr);
             
             
-            if(newShapeSortMethod) {
+                if(newShapeSortMethod) {
                 
-                //cout << " NEW SHAPE SORT START -------------- " <<sortedshapes.size()<<  endl;
+                    //cout << " NEW SHAPE SORT START -------------- " <<sortedshapes.size()<<  endl;
              
-                // reset the tested flags
-                for (PointsForShape* shape : sortedshapes) shape->tested = false;
+                    // reset the tested flags
+                    for (PointsForShape* shape : sortedshapes) shape->tested = false;
              
-                // start at the end
-                int currentIndex = sortedshapes.size()-1;
+                    // start at the end
+                    int currentIndex = sortedshapes.size()-1;
                 
-                while(currentIndex>1) { // don't think we need to do this process for 0 and 1
+                    while(currentIndex>1) { // don't think we need to do this process for 0 and 1
                 
-                    PointsForShape& shape = *sortedshapes[currentIndex];
-                    if(shape.tested) {
-                        currentIndex--;
-                        continue;
-                    }
-                    // position to move this shape to
-                    int targetIndex = currentIndex;
+                        PointsForShape& shape = *sortedshapes[currentIndex];
+                        if(shape.tested) {
+                            currentIndex--;
+                            continue;
+                        }
+                        // position to move this shape to
+                        int targetIndex = currentIndex;
                     
-                    // get the distance between this and its two neighbours
-                    PointsForShape& neighbourAfter = *sortedshapes[(currentIndex+1) % sortedshapes.size()];
-                    PointsForShape& neighbourBefore = *sortedshapes[currentIndex-1]; // should always be >0
+                        // get the distance between this and its two neighbours
+                        PointsForShape& neighbourAfter = *sortedshapes[(currentIndex+1) % sortedshapes.size()];
+                        PointsForShape& neighbourBefore = *sortedshapes[currentIndex-1]; // should always be >0
                   
-                    float distanceToBeat = neighbourAfter.getStart().distance(shape.getEnd()) + shape.getStart().distance(neighbourBefore.getEnd()) - neighbourBefore.getEnd().distance(neighbourAfter.getStart());
-                    distanceToBeat *= 0.95; // so close calls do nothing
+                        float distanceToBeat = neighbourAfter.getStart().distance(shape.getEnd()) + shape.getStart().distance(neighbourBefore.getEnd()) - neighbourBefore.getEnd().distance(neighbourAfter.getStart());
+                        distanceToBeat *= 0.95; // so close calls do nothing
                     
-                    // now iterate back to the first shape
-                    for(int i = currentIndex-1; i>0; i--) { // don't think we need to go all the way back to 0
-                        // check the distance if we were to insert the shape between i and i-1
-                        int shapeIndexBefore = (i==0) ? sortedshapes.size()-1 : i-1 ;
-                        int shapeIndexAfter = i;
+                        // now iterate back to the first shape
+                        for(int i = currentIndex-1; i>0; i--) { // don't think we need to go all the way back to 0
+                            // check the distance if we were to insert the shape between i and i-1
+                            int shapeIndexBefore = (i==0) ? sortedshapes.size()-1 : i-1 ;
+                            int shapeIndexAfter = i;
                         
-                        PointsForShape& shapeBefore = *sortedshapes[shapeIndexBefore];
-                        PointsForShape& shapeAfter = *sortedshapes[shapeIndexAfter];
+                            PointsForShape& shapeBefore = *sortedshapes[shapeIndexBefore];
+                            PointsForShape& shapeAfter = *sortedshapes[shapeIndexAfter];
                         
-                        float distanceToCompare = shapeBefore.getEnd().distance(shape.getStart()) + shape.getEnd().distance(shapeAfter.getStart()) -                            shapeBefore.getEnd().distance(shapeAfter.getStart());
+                            float distanceToCompare = shapeBefore.getEnd().distance(shape.getStart()) + shape.getEnd().distance(shapeAfter.getStart()) -                            shapeBefore.getEnd().distance(shapeAfter.getStart());
                         
-                       // if((shape.getStart()!=shape.getEnd()) && (shapeBefore.getEnd().squareDistance(shapeAfter.getStart()) < 1)) continue; // if the shapes are connected don't insert a new one here unless it starts and ends at the same place
+                           // if((shape.getStart()!=shape.getEnd()) && (shapeBefore.getEnd().squareDistance(shapeAfter.getStart()) < 1)) continue; // if the shapes are connected don't insert a new one here unless it starts and ends at the same place
                        
-                        if(distanceToCompare<distanceToBeat) {
-                            // set target position of this shape to be i
-                            targetIndex = i;
-                            distanceToBeat = distanceToCompare; 
-                        }
+                            if(distanceToCompare<distanceToBeat) {
+                                // set target position of this shape to be i
+                                targetIndex = i;
+                                distanceToBeat = distanceToCompare; 
+                            }
                     
-                    }
+                        }
                     
-                    shape.tested = true;
-                    // if the target position != currentIndex then move it there
-                    if(targetIndex!=currentIndex) {
-                        sortedshapes.erase(sortedshapes.begin() + currentIndex);
-                        //if(targetIndex == 0 ) targetIndex = sortedshapes.size();
-                        sortedshapes.insert(sortedshapes.begin() +targetIndex, &shape);
-                        //ofLogNotice("moving shape at ") << currentIndex << " to " << targetIndex;
-                    } else {
-                        // else subtract 1 from the currentIndex
-                        currentIndex--;
+                        shape.tested = true;
+                        // if the target position != currentIndex then move it there
+                        if(targetIndex!=currentIndex) {
+                            sortedshapes.erase(sortedshapes.begin() + currentIndex);
+                            //if(targetIndex == 0 ) targetIndex = sortedshapes.size();
+                            sortedshapes.insert(sortedshapes.begin() +targetIndex, &shape);
+                            //ofLogNotice("moving shape at ") << currentIndex << " to " << targetIndex;
+                        } else {
+                            // else subtract 1 from the currentIndex
+                            currentIndex--;
+                        }
                     }
-                }
                 
-                //cout << "----------------------------------- " << endl;
+                    //cout << "----------------------------------- " << endl;
 
                 
                 
+                }
             }
             
             if(alwaysClockwise) {
@@ -806,15 +839,21 @@ void Laser::send(ofPixels* pixels, float masterIntensity) {
                     allzoneshapes[j].reversed = false;
                     sortedshapes.push_back(&allzoneshapes[j]);
                 }
-                
+                moveDistanceForSortedShapes = moveDistanceForUnSortedShapes;
             }
+            blankMoveDistance = moveDistanceForSortedShapes;
+            if(reuseShapeOrder) shapeOrderCache.storeOrder(allzoneshapes, sortedshapes);
             
 		} else {
 			for(size_t j = 0; j<allzoneshapes.size(); j++) {
 				sortedshapes.push_back(&allzoneshapes[j]);
 			}
-			
+			blankMoveDistance = getMoveDistanceForShapes(sortedshapes);
 		}
+        if(sortShapes) {
+            float sortTimeMicros = ofGetElapsedTimeMicros() - sortStartTime;
+            smoothedSortTimeMicros += (sortTimeMicros - smoothedSortTimeMicros)*0.1;
+        }
 		
 
 		// go through the point objects
@@ -889,10 +928,8 @@ void Laser::send(ofPixels* pixels, float masterIntensity) {
 		
 		targetNumPoints = round((float)pps / targetFramerate);
 		
-		if(syncShift!=0) {
-			targetNumPoints+=syncShift;
-			if(!ofGetMousePressed()) syncShift = 0;
-		}
+		// syncShift is reset in sendRenderedFrame
+		targetNumPoints+=syncShift;
 		
 		while (laserPoints.size() < targetNumPoints) {
 			addPoint(laserHomePosition, ofColor::black);
@@ -906,7 +943,6 @@ void Laser::send(ofPixels* pixels, float masterIntensity) {
 		ofLogError("syncToTargetFramerate failed! " + ofToString(targetNumPoints)+ " " + ofToString(laserPoints.size()));
 	}
 	
-	dac->sendFrame(laserPoints);
     numPoints = (int)laserPoints.size();
 	
 	if(sortedshapes.size()>0) {
@@ -916,12 +952,56 @@ void Laser::send(ofPixels* pixels, float masterIntensity) {
 			laserHomePosition = sortedshapes.back()->getEnd();
 		}
 	}
+	
+	lastFrameBufferGrowth = countBufferGrowth();
+	bufferGrowthCount += lastFrameBufferGrowth;
+	
+	renderTimeMicros = ofGetElapsedTimeMicros() - renderStartTime;
+	smoothedRenderTimeMicros += ((float)renderTimeMicros - smoothedRenderTimeMicros)*0.1;
+}
+
+void Laser::sendRenderedFrame() {
+	
+	if(!guiInitialised) return;
+	
+	dac->sendFrame(laserPoints);
+	
+	// changing the parameter calls the listeners, so not on a worker thread
+	if(syncToTargetFramerate && (syncShift!=0) && !ofGetMousePressed()) syncShift = 0;
+}
+
+float Laser :: getRenderTimeMillis() {
+	return smoothedRenderTimeMicros/1000.0f;
+}
+
+float Laser :: getSortTimeMillis() {
+	return smoothedSortTimeMicros/1000.0f;
+}
+
+int Laser :: countBufferGrowth() {
+	
+	// the number of frame buffers that have grown since last time
+	size_t capacities[numFrameBuffers] = {
+		pointArena.capacity(),
+		shapePieceSizes.capacity(),
+		shapeSegments.capacity(),
+		sortedShapeSegments.capacity(),
+		laserPoints.capacity()
+	};
+	int count = 0;
+	for(int i = 0; i<numFrameBuffers; i++) {
+		if(capacities[i]!=frameBufferCapacities[i]) {
+			count++;
+			frameBufferCapacities[i] = capacities[i];
+		}
+	}
+	return count;
 }
 
 float Laser ::getMoveDistanceForShapes(vector<PointsForShape>& shapes){
     float distance = 0;
     ofPoint position = laserHomePosition;
-    for(PointsForShape shape : shapes) {
+    for(PointsForShape& shape : shapes) {
         distance+= shape.getStart().distance(position);
         position = shape.getEnd();
     }
@@ -942,13 +1022,16 @@ float Laser ::getMoveDistanceForShapes(vector<PointsForShape*>& shapes){
 }
 
 
-void Laser ::getAllShapePoints(vector<PointsForShape>* shapepointscontainer, ofPixels*pixels, float speedmultiplier){
+void Laser ::getAllShapePoints(vector<PointsForShape>* shapepointscontainer, BitmapMaskManager* bitmapMask, float speedmultiplier){
 	
 	vector<PointsForShape>& allzoneshapepoints = *shapepointscontainer;
 	
-	// temp vectors for storing the shapes in
-	vector<PointsForShape> zonePointsForShapes;
-	vector<Point> shapePointBuffer;
+	// all the points go into the point arena and the shape segments just
+	// refer to a range within it. Both are reused every frame so once
+	// they're big enough there's nothing to allocate.
+	pointArena.clear();
+	allzoneshapepoints.clear();
+	testPatternArena.reset();
 	
 	// go through each zone
 	//for(int i = 0; i<(int)laserZones.size(); i++) {
@@ -964,16 +1047,13 @@ void Laser ::getAllShapePoints(vector<PointsForShape>* shapepointscontainer, ofP
         // CHECK - is this OK ?
 		deque<Shape*>* zoneshapes = &zone.shapes;
 		
-        // get test pattern shapes - we have to do this even if
-        // we don't have a test pattern, so that the code at the end
-        // of this function can delete the shapes.
-        deque<Shape*> testPatternShapes = getTestPatternShapesForZone(*laserZone);
-        
-        // define this here so we don't lose scope
-        deque<Shape*> zoneShapesWithTestPatternShapes;
-        
         if(testPattern>0) {
+            // get test pattern shapes, they're reused next frame
+            testPatternShapes.clear();
+            getTestPatternShapesForZone(*laserZone, testPatternShapes);
+            
             // copy zone shapes into it
+            zoneShapesWithTestPatternShapes.clear();
             if(!hideContentDuringTestPattern) zoneShapesWithTestPatternShapes = zone.shapes;
             
             // add testpattern points for this zone...
@@ -986,8 +1066,8 @@ void Laser ::getAllShapePoints(vector<PointsForShape>* shapepointscontainer, ofP
         // a reference to the zone shapes
         deque<Shape*>& shapesInZone = *zoneshapes;
         
-        // reuse the last vector of shapepoints
-		zonePointsForShapes.clear();
+        // where this zone's points start in the arena
+		size_t zoneFirstPoint = pointArena.size();
 		
 		// go through each shape in the zone
 		
@@ -998,135 +1078,35 @@ void Laser ::getAllShapePoints(vector<PointsForShape>* shapepointscontainer, ofP
 			
 			RenderProfile& renderProfile = getRenderProfile(shape.profileLabel);
 			
-            // calculate the points for the shape and put them
-            // in the temporary point storage buffer.
-			shapePointBuffer.clear();
-			shape.appendPointsToVector(shapePointBuffer, renderProfile, speedmultiplier);
-			
-            // now we need to go through the shape and see if any of it is
-            // off the edge of the input zone. If it is we split the
-            // shape up into separate segments.
-            
-			bool offScreen = true;
-			PointsForShape segmentPoints;
-            segmentPoints.reversable = shape.reversable;
-            
-			//iterate through the points
-			for(int k = 0; k<shapePointBuffer.size(); k++) {
-				
-				Point& p = shapePointBuffer[k];
-				
-				// check each point against the mask
-				// are we outside the edge mask?
-                // NB can't use inside because I want points on the edge
-				
-                // if we are outside the mask area
-				if(p.x<maskRectangle.getLeft() ||
-				   p.x>maskRectangle.getRight() ||
-				   p.y<maskRectangle.getTop() ||
-				   p.y>maskRectangle.getBottom())  {
-					
-                    // and we're not already offscreen
-                    if(!offScreen) {
-						offScreen = true;
-						// if we already have points then add an end point
-                        // for the shape that is on the edge of the mask
-						if(k>0) {
-                            
-							Point lastpoint = p;
-							
-							// TODO better point on edge rather than just clamp
-							lastpoint.x = ofClamp(lastpoint.x, maskRectangle.getLeft(), maskRectangle.getRight());
-							lastpoint.y = ofClamp(lastpoint.y, maskRectangle.getTop(), maskRectangle.getBottom());
-							segmentPoints.push_back(lastpoint);
-							
-							// add this bunch to the collection for this zone
-							zonePointsForShapes.push_back(segmentPoints); // should copy
-							
-							//clear the vector and start again
-							segmentPoints.clear();
-							
-						}
-					}
-                    // otherwise if we are already off screen we don't need
-                    // to do anything except ignore this point
-				
-                // else if we are inside the mask rectangle
-				} else {
-                    
-					// and we're currently off screen
-					if(offScreen) {
-						// clear the points - do we need to if we
-                        // cleared them already at the end of the last one?
-						segmentPoints.clear();
-						offScreen = false;
-                        // if we have points already
-						if(k>0) {
-                            
-                            // then figure out the position on the edge
-                            // of the mask
-							Point lastpoint = shapePointBuffer[k-1];
-							
-							// TODO better point on edge rather than just clamp
-							lastpoint.x = ofClamp(lastpoint.x, maskRectangle.getLeft(), maskRectangle.getRight());
-							lastpoint.y = ofClamp(lastpoint.y, maskRectangle.getTop(), maskRectangle.getBottom());
-                            
-                            // and add it to the beginning of the new segment
-                            segmentPoints.push_back(lastpoint);
-						}
-					}
-                    
-                    // either way, add this next point because we are on screen
-					segmentPoints.push_back(p);
-				}
-				
+            // calculate the points for the parts of the shape that are inside
+            // the zone mask and put them straight into the arena. If the shape
+            // goes off the edge it's split into separate pieces.
+			size_t pieceStart = pointArena.size();
+			shapePieceSizes.clear();
+			shape.appendClippedPointsToVector(pointArena, shapePieceSizes, maskRectangle, renderProfile, speedmultiplier);
 			
-				
-			}
-			// add the final segment points to zone points
-			if(segmentPoints.size()>0) {
-				zonePointsForShapes.push_back(segmentPoints);
+			for(size_t piecesize : shapePieceSizes) {
+				allzoneshapepoints.push_back(PointsForShape(&pointArena, pieceStart, piecesize));
+				allzoneshapepoints.back().reversable = shape.reversable;
+				pieceStart+=piecesize;
 			}
 			
 		} // end zoneshapes
 		
 		
 		// go through all the points and warp them into output space
-		for(size_t j = 0; j<zonePointsForShapes.size(); j++) {
-			PointsForShape& segmentpoints = zonePointsForShapes[j];
-			for(int k= 0; k<segmentpoints.size(); k++) {
-				
-				// Check against the mask image
-				if(pixels!=NULL) {
-					Point& p = segmentpoints[k];
-					ofFloatColor c = pixels->getColor(p.x, p.y);
-					float brightness = c.getBrightness();
-					p.r*=brightness;
-					p.g*=brightness;
-					p.b*=brightness;
-				}
-                Point& p = segmentpoints[k];
-                p = warp.getWarpedPoint(p);
-                
-                // check if it's in any of the masks!
-                for(QuadMask* mask : maskManager.quads){
-                    if(mask->hitTest(p)) {
-                        p.multiplyColour(ofMap(mask->maskLevel,100,0,0,1));
-                    }
-                }
-                
-			}
+		size_t zoneNumPoints = pointArena.size()-zoneFirstPoint;
+		
+		// Check against the mask image
+		if(bitmapMask!=NULL) {
+			bitmapMask->applyBrightness(pointArena.data()+zoneFirstPoint, zoneNumPoints);
 		}
 		
+		warp.getWarpedPoints(pointArena.data()+zoneFirstPoint, zoneNumPoints);
 		
-		// add all the segments for the zone into the big container for all the segs
-		allzoneshapepoints.insert(allzoneshapepoints.end(), zonePointsForShapes.begin(), zonePointsForShapes.end());
+		// check if it's in any of the masks!
+		maskManager.applyQuadMasks(pointArena.data()+zoneFirstPoint, zoneNumPoints);
 		
-		// delete all the test pattern shapes
-		for(size_t j = 0; j<testPatternShapes.size(); j++) {
-			delete testPatternShapes[j];
-		}
-
 		testPatternShapes.clear();
 		
 	} // end zones
@@ -1149,10 +1129,9 @@ RenderProfile& Laser::getRenderProfile(string profilelabel) {
 	
 }
 
-deque<Shape*> Laser ::getTestPatternShapesForZone(LaserZone& laserZone) {
+void Laser ::getTestPatternShapesForZone(LaserZone& laserZone, deque<Shape*>& shapes) {
 	
-	deque<Shape*> shapes;
-    if(testPattern==0) return shapes;
+    if(testPattern==0) return;
    
 	Zone& zone = laserZone.zone;
 
@@ -1163,12 +1142,12 @@ deque<Shape*> Laser ::getTestPatternShapesForZone(LaserZone& laserZone) {
 		ofRectangle& rect = maskRectangle;
 
 		ofColor col = ofColor(0,255,0);
-		shapes.push_back(new Line(rect.getTopLeft(), rect.getTopRight(), col, OFXLASER_PROFILE_FAST));
-		shapes.push_back(new Line(rect.getTopRight(), rect.getBottomRight(), col, OFXLASER_PROFILE_FAST));
-		shapes.push_back(new Line(rect.getBottomRight(), rect.getBottomLeft(), col, OFXLASER_PROFILE_FAST));
-		shapes.push_back(new Line(rect.getBottomLeft(), rect.getTopLeft(), col, OFXLASER_PROFILE_FAST));
-		shapes.push_back(new Line(rect.getTopLeft(), rect.getBottomRight(), col, OFXLASER_PROFILE_FAST));
-		shapes.push_back(new Line(rect.getTopRight(), rect.getBottomLeft(), col, OFXLASER_PROFILE_FAST));
+		shapes.push_back(getTestPatternLine(rect.getTopLeft(), rect.getTopRight(), col, OFXLASER_PROFILE_FAST));
+		shapes.push_back(getTestPatternLine(rect.getTopRight(), rect.getBottomRight(), col, OFXLASER_PROFILE_FAST));
+		shapes.push_back(getTestPatternLine(rect.getBottomRight(), rect.getBottomLeft(), col, OFXLASER_PROFILE_FAST));
+		shapes.push_back(getTestPatternLine(rect.getBottomLeft(), rect.getTopLeft(), col, OFXLASER_PROFILE_FAST));
+		shapes.push_back(getTestPatternLine(rect.getTopLeft(), rect.getBottomRight(), col, OFXLASER_PROFILE_FAST));
+		shapes.push_back(getTestPatternLine(rect.getTopRight(), rect.getBottomLeft(), col, OFXLASER_PROFILE_FAST));
 
 
 	} else if(testPattern==2) {
@@ -1178,18 +1157,18 @@ deque<Shape*> Laser ::getTestPatternShapesForZone(LaserZone& laserZone) {
 		ofPoint v = rect.getBottomRight() - rect.getTopLeft()-ofPoint(0.2,0.2);
 		for(float y = 0; y<=1.1; y+=0.333333333) {
 
-			shapes.push_back(new Line(ofPoint(rect.getLeft()+0.1, rect.getTop()+0.1+v.y*y),ofPoint(rect.getRight()-0.1, rect.getTop()+0.1+v.y*y), ofColor(255), OFXLASER_PROFILE_FAST));
+			shapes.push_back(getTestPatternLine(ofPoint(rect.getLeft()+0.1, rect.getTop()+0.1+v.y*y),ofPoint(rect.getRight()-0.1, rect.getTop()+0.1+v.y*y), ofColor(255), OFXLASER_PROFILE_FAST));
 		}
 
 		for(float x =0 ; x<=1.1; x+=0.3333333333) {
 
 
-			shapes.push_back(new Line(ofPoint(rect.getLeft()+0.1+ v.x*x, rect.getTop()+0.1),ofPoint(rect.getLeft()+0.1 + v.x*x, rect.getBottom()-0.1), ofColor(255,0,0), OFXLASER_PROFILE_FAST ));
+			shapes.push_back(getTestPatternLine(ofPoint(rect.getLeft()+0.1+ v.x*x, rect.getTop()+0.1),ofPoint(rect.getLeft()+0.1 + v.x*x, rect.getBottom()-0.1), ofColor(255,0,0), OFXLASER_PROFILE_FAST ));
 
 		}
 
-		shapes.push_back(new Circle(rect.getCenter(), rect.getWidth()/12, ofColor(0,0,255), OFXLASER_PROFILE_DEFAULT));
-		shapes.push_back(new Circle(rect.getCenter(), rect.getWidth()/6, ofFloatColor(0,1,0), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternCircle(rect.getCenter(), rect.getWidth()/12, ofColor(0,0,255), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternCircle(rect.getCenter(), rect.getWidth()/6, ofFloatColor(0,1,0), OFXLASER_PROFILE_DEFAULT));
 
 
 
@@ -1201,13 +1180,13 @@ deque<Shape*> Laser ::getTestPatternShapesForZone(LaserZone& laserZone) {
 
 		for(float y = 0; y<=1.1; y+=0.333333333) {
 
-			shapes.push_back(new Line(ofPoint(rect.getLeft()+0.1, rect.getTop()+0.1+v.y*y),ofPoint(rect.getRight()-0.1, rect.getTop()+0.1+v.y*y), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
+			shapes.push_back(getTestPatternLine(ofPoint(rect.getLeft()+0.1, rect.getTop()+0.1+v.y*y),ofPoint(rect.getRight()-0.1, rect.getTop()+0.1+v.y*y), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
 		}
-		shapes.push_back(new Line(rect.getTopLeft(),  glm::mix( rect.getTopLeft(), rect.getBottomLeft(), 1.0f/3.0f ), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternLine(rect.getTopLeft(),  glm::mix( rect.getTopLeft(), rect.getBottomLeft(), 1.0f/3.0f ), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
 
-		shapes.push_back(new Line(rect.getBottomLeft(), glm::mix(rect.getTopLeft(), rect.getBottomLeft(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternLine(rect.getBottomLeft(), glm::mix(rect.getTopLeft(), rect.getBottomLeft(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
 
-		shapes.push_back(new Line( glm::mix(rect.getTopRight(), rect.getBottomRight(), 1.0f/3.0f), mix(rect.getTopRight(), rect.getBottomRight(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternLine( glm::mix(rect.getTopRight(), rect.getBottomRight(), 1.0f/3.0f), mix(rect.getTopRight(), rect.getBottomRight(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
 
 
 	} else if(testPattern==4) {
@@ -1217,15 +1196,15 @@ deque<Shape*> Laser ::getTestPatternShapesForZone(LaserZone& laserZone) {
 		ofPoint v = rect.getBottomRight() - rect.getTopLeft()-ofPoint(0.2,0.2);
 
 		for(float x =0 ; x<=1.1; x+=0.3333333333) {
-			shapes.push_back(new Line(ofPoint(rect.getLeft()+0.1+ v.x*x, rect.getTop()+0.1),ofPoint(rect.getLeft()+0.1 + v.x*x, rect.getBottom()-0.1), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT ));
+			shapes.push_back(getTestPatternLine(ofPoint(rect.getLeft()+0.1+ v.x*x, rect.getTop()+0.1),ofPoint(rect.getLeft()+0.1 + v.x*x, rect.getBottom()-0.1), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT ));
 
 		}
 
-		shapes.push_back(new Line(rect.getTopLeft(), glm::mix( rect.getTopLeft(), rect.getTopRight(), 1.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternLine(rect.getTopLeft(), glm::mix( rect.getTopLeft(), rect.getTopRight(), 1.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
 
-		shapes.push_back(new Line(rect.getTopRight(), glm::mix( rect.getTopLeft(), rect.getTopRight(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternLine(rect.getTopRight(), glm::mix( rect.getTopLeft(), rect.getTopRight(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
 
-		shapes.push_back(new Line(glm::mix(rect.getBottomLeft(), rect.getBottomRight(), 1.0f/3.0f), glm::mix(rect.getBottomLeft(), rect.getBottomRight(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternLine(glm::mix(rect.getBottomLeft(), rect.getBottomRight(), 1.0f/3.0f), glm::mix(rect.getBottomLeft(), rect.getBottomRight(), 2.0f/3.0f), ofColor(0,255,0), OFXLASER_PROFILE_DEFAULT));
 
 
 	} else if((testPattern>=5) && (testPattern<=8)) {
@@ -1234,8 +1213,10 @@ deque<Shape*> Laser ::getTestPatternShapesForZone(LaserZone& laserZone) {
 		ofRectangle rect = maskRectangle;
 
 		rect.scaleFromCenter(0.5, 0.1);
-		vector<ofPoint> points;
-		vector<ofColor> colours;
+		vector<ofPoint>& points = testPatternPoints;
+		vector<ofColor>& colours = testPatternColours;
+		points.clear();
+		colours.clear();
 
 		ofPoint currentPosition = rect.getTopLeft();
 
@@ -1310,22 +1291,42 @@ deque<Shape*> Laser ::getTestPatternShapesForZone(LaserZone& laserZone) {
 
 
 		}
-		shapes.push_back(new ManualShape(points, colours, false,OFXLASER_PROFILE_DEFAULT));
+		ManualShape* manualshape = testPatternArena.getManualShape();
+		manualshape->init(points, colours, false, OFXLASER_PROFILE_DEFAULT);
+		shapes.push_back(manualshape);
 
 	} else if(testPattern ==9) {
 		ofRectangle rect = maskRectangle;
 
-		shapes.push_back(new Dot(rect.getTopLeft(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
-		shapes.push_back(new Dot(rect.getTopRight(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
-		shapes.push_back(new Dot(rect.getBottomLeft(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
-		shapes.push_back(new Dot(rect.getBottomRight(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternDot(rect.getTopLeft(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternDot(rect.getTopRight(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternDot(rect.getBottomLeft(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
+		shapes.push_back(getTestPatternDot(rect.getBottomRight(), ofColor(255,255,255), 1, OFXLASER_PROFILE_DEFAULT));
 
 	}
-	return shapes; 
+	return;
 	
 }
 
 
+Line* Laser :: getTestPatternLine(const ofPoint& start, const ofPoint& end, const ofColor& col, const string& profilelabel) {
+	Line* line = testPatternArena.getLine();
+	line->init(start, end, col, profilelabel);
+	return line;
+}
+
+Circle* Laser :: getTestPatternCircle(const ofPoint& centre, float radius, const ofColor& col, const string& profilelabel) {
+	Circle* circle = testPatternArena.getCircle();
+	circle->init(centre, radius, col, profilelabel);
+	return circle;
+}
+
+Dot* Laser :: getTestPatternDot(const ofPoint& pos, const ofColor& col, float intensity, const string& profilelabel) {
+	Dot* dot = testPatternArena.getDot();
+	dot->init(pos, col, intensity, profilelabel);
+	return dot;
+}
+
 void Laser :: addPointsForMoveTo(const ofPoint & currentPosition, const ofPoint & targetpoint){
 
 	ofPoint target = targetpoint;
@@ -1363,14 +1364,26 @@ void Laser :: addPoints(vector<ofxLaser::Point>&points, bool reversed) {
 		}
 	}
 }
+void Laser :: addPoints(PointsForShape& points, bool reversed) {
+	if(!reversed) {
+		for(size_t i = 0; i<points.size();i++) {
+			addPoint(points[i]);
+		}
+	} else {
+		for(int i=(int)points.size()-1;i>=0; i--) {
+			addPoint(points[i]);
+		}
+	}
+}
 
 void Laser :: addPoint(ofxLaser::Point p) {
 	
-	p+=(ofPoint)outputOffset;
-	
+	// the output offset is added in processPoints along with the
+	// rest of the output transform
 	laserPoints.push_back(p);
 	
-	previewPathMesh.addVertex(ofPoint(p.x, p.y));
+	const glm::vec2& offset = outputOffset.get();
+	previewPathMesh.addVertex(ofPoint(p.x+offset.x, p.y+offset.y));
 
 }
 
@@ -1381,106 +1394,65 @@ void  Laser :: processPoints(float masterIntensity, bool offsetColours) {
 	// Lasers usually change colour sooner than the mirrors can move to the next
 	// position, so the colourChangeOffset system
 	// mitigates against that by shifting the colours for the points.
-	// Some optimisation makes this slightly hard to read but we iterate through
-	// the points backwards, and store the .
-	// To avoid creating a whole new vector, we're storing the overlap in a buffer of
-	// colours.
-	// I'm sure there must be some slicker C++ way of doing this...
+	// Every colour goes into a ring buffer as we go through the points and
+	// each point then takes the colour from a little earlier in the buffer.
+	// The buffer carries on from one frame to the next so the colours at the
+	// end of a frame are shifted into the start of the next one.
 	
 	frameCounter++;
 	
 	if(offsetColours) {
-        // the offset value is in time, so we convert it to a number of points.
-		// this way we can change the PPS and this should still work
-        // TODO do we need to take into account the speed multiplier?
-		int colourChangeIndexOffset = (float)pps/10000.0f*colourChangeShift ;
+		// the offset value is in time, so we convert it to a number of points.
+		// this way we can change the PPS and this should still work. It
+		// doesn't depend on the speed multiplier because that changes the
+		// spacing of the points, not how long each one takes.
+		// The delay doesn't have to be a whole number of points, the
+		// colour is interpolated between the two nearest.
+		float colourDelay = ofClamp((float)pps/10000.0f*colourChangeShift, 0, colourDelayBufferSize-2);
+		int delay = (int)colourDelay;
+		float fraction = colourDelay-delay;
 		
-		// we switch the front and rear buffers every frame, so we copy the
-		// rear points to the front
-		vector<Point>& frontBuffer = (frameCounter%2==0) ? sparePoints : sparePoints2;
-		vector<Point>& rearBuffer = (frameCounter%2==0) ? sparePoints2 : sparePoints;
-
-		// we change the colour later, ie we shift the colours forward (later)
-		
-		// resize the spare points to match the number we need
-		if(rearBuffer.size()!= colourChangeIndexOffset) {
-			// should be blank point but might wanna give it a
-			// default value with the current position
-			rearBuffer.resize(colourChangeIndexOffset);
-			// maybe do some other stuff as well for safety
-		}
-		if(frontBuffer.size()!= colourChangeIndexOffset) {
-			frontBuffer.resize(colourChangeIndexOffset);
-		}
+		glm::vec3* buffer = colourDelayBuffer;
+		const size_t mask = colourDelayBufferSize-1;
+		size_t writeindex = colourDelayWriteIndex;
 		
-		for(int i = (int)(laserPoints.size()+rearBuffer.size())-1; i>=0; i--) {
+		for(size_t i = 0; i<laserPoints.size(); i++) {
+			Point& p = laserPoints[i];
+			buffer[writeindex & mask] = glm::vec3(p.r, p.g, p.b);
 			
-			Point& p = (i<laserPoints.size()) ? laserPoints[i] : rearBuffer[i-laserPoints.size()];
-
-			//now shift the colour from an earlier point
-			if(i>=colourChangeIndexOffset){
-				p.copyColourFromPoint(laserPoints[i-colourChangeIndexOffset]);
-			} else {
-				p.copyColourFromPoint(frontBuffer[i-colourChangeIndexOffset+frontBuffer.size()]);
-			}
+			const glm::vec3& c1 = buffer[(writeindex-delay) & mask];
+			const glm::vec3& c2 = buffer[(writeindex-delay-1) & mask];
+			p.r = c1.r + ((c2.r-c1.r)*fraction);
+			p.g = c1.g + ((c2.g-c1.g)*fraction);
+			p.b = c1.b + ((c2.b-c1.b)*fraction);
+			
+			writeindex++;
 		}
+		colourDelayWriteIndex = writeindex & mask;
 	}
 
 	
-	for(size_t i = 0; i<laserPoints.size(); i++) {
-		
-		ofxLaser::Point &p = laserPoints[i];
-    
-		
-		if(flipY) p.y= 800-p.y;
-		if(flipX) p.x= 800-p.x;
-		if(rotation!=0) {
-			p.x-=400;
-			p.y-=400;
-
-			glm::vec3 vec = glm::vec3(p.x,p.y,0);
-			float angle = ofDegToRad(rotation);
-			
-			glm::vec2 rotatedVec = glm::rotate(vec, angle, glm::vec3(0.0f, 0.0f, 1.0f));
-			p.x=rotatedVec.x+400;
-			p.y=rotatedVec.y+400;
-
-		}
-		
-		// bounds check
-        if(p.x<0) {
-            p.x = p.r = p.g = p.b = 0;
-        } else if(p.x>800) {
-			p.x = 800;
-			p.r = p.g = p.b = 0;
-		}
-        if(p.y<0) {
-            p.y = p.r = p.g = p.b = 0;
-        } else if(p.y>800) {
-			p.y = 800;
-			p.r = p.g = p.b = 0;
-		}
-		
-		if(p.useCalibration) {
-            colourSettings.processColour(p, intensity*masterIntensity);
-        } else {
-            
-            
-        }
-		
-		if(!armed) {
+	// offset, flip, rotate and bounds check all in one go
+	outputTransform.set(outputOffset, flipX, flipY, rotation);
+	outputTransform.apply(laserPoints.data(), laserPoints.size());
+	
+	colourSettings.processColours(laserPoints.data(), laserPoints.size(), intensity*masterIntensity);
+	
+	if(!armed) {
+		for(size_t i = 0; i<laserPoints.size(); i++) {
+			ofxLaser::Point &p = laserPoints[i];
 			p.r = 0;
 			p.g = 0;
 			p.b = 0;
 		}
-	
-		
 	}
 	
 }
 
 
 void Laser::paramsChanged(ofAbstractParameter& e){
+    // any of the sort settings could have changed
+    shapeOrderCache.clear();
     if(ignoreParamChange) return;
     else saveSettings();
 }
@@ -15,45 +15,20 @@
 #include "ofxLaserManualShape.h"
 #include "PennerEasing.h"
 #include "ofxLaserMaskManager.h"
+#include "ofxLaserBitmapMaskManager.h"
 #include "ofxLaserScannerSettings.h"
 #include "ofxLaserLine.h"
 #include "ofxLaserColourSettings.h"
 #include "ofxLaserCircle.h"
+#include "ofxLaserPointsForShape.h"
+#include "ofxLaserShapeSorter.h"
+#include "ofxLaserShapeOrderCache.h"
+#include "ofxLaserShapeArena.h"
+#include "ofxLaserOutputTransform.h"
 
 
 namespace ofxLaser {
 
-// a container than holds all the points for a shape
-// it extends a vector of ofxLaser::Point objects
-class PointsForShape : public vector<Point> {
-    
-    public:
-    bool tested = false;
-    bool reversed = false;
-    bool reversable = true;
-    Point& getStart() {
-        return reversed?this->back() : this->front();
-    }
-    Point& getEnd() {
-        return reversed?this->front() : this->back();
-    }
-    
-    glm::vec3 getStartGlm() {
-        glm::vec3 p;
-        p.x = reversed ? this->back().x : this->front().x;
-        p.y = reversed ? this->back().y : this->front().y;
-        return p;
-    }
-    glm::vec3 getEndGlm() {
-        glm::vec3 p;
-        p.x = reversed ? this->front().x : this->back().x;
-        p.y = reversed ? this->front().y : this->back().y;
-        return p;
-    }
-    
-};
-
-
 class Laser {
     
     public :
@@ -78,17 +53,32 @@ class Laser {
     void setDefaultHandleSize(float size);
     
     void update(bool updateZones);
-    void send(ofPixels* pixels = NULL, float masterIntensity = 1);
+    // renders the frame and sends it to the DAC
+    void send(BitmapMaskManager* bitmapMask = NULL, float masterIntensity = 1);
+    // send() in two halves. render() only reads the shared shapes so it can
+    // run on a worker thread, sendRenderedFrame() has to be on the main thread
+    void render(BitmapMaskManager* bitmapMask = NULL, float masterIntensity = 1);
+    void sendRenderedFrame();
     
     bool toggleArmed(); 
    
     // adds all the shape points to the vector passed in
-    void getAllShapePoints(vector<PointsForShape>* allzoneshapepoints, ofPixels*pixels, float speedmultiplier);
+    void getAllShapePoints(vector<PointsForShape>* allzoneshapepoints, BitmapMaskManager* bitmapMask, float speedmultiplier);
 
     
     void sendRawPoints(const vector<Point>& points, Zone* zone, float masterIntensity =1);
     int getPointRate();
+    // the number of points in a frame at the target framerate
+    float getPointBudget();
+    // roughly how many points it'll take to draw the shape, not including
+    // moving to it
+    float getPointEstimate(Shape& shape);
     float getFrameRate();
+    // smoothed time taken by the last calls to send(), in milliseconds
+    float getRenderTimeMillis();
+    // smoothed time taken to sort the shapes, in milliseconds
+    float getSortTimeMillis();
+    const ShapeOrderCache& getShapeOrderCache() { return shapeOrderCache; }
     
     // DAC
     
@@ -116,6 +106,7 @@ class Laser {
     void addPoint(ofxLaser::Point p);
     void addPoint(ofPoint p, ofFloatColor c, bool useCalibration = true);
     void addPoints(vector<ofxLaser::Point>&points, bool reversed = false);
+    void addPoints(PointsForShape& points, bool reversed = false);
 
     void addPointsForMoveTo(const ofPoint & currentPosition, const ofPoint & targetpoint);
     void processPoints(float masterIntensity, bool offsetColours = true);
@@ -126,7 +117,12 @@ class Laser {
     
     void ppsChanged(int& e);
     
-    deque<Shape*> getTestPatternShapesForZone(LaserZone& zone);
+    // adds the test pattern shapes to the deque. They come from
+    // testPatternArena so they're only valid until the next frame
+    void getTestPatternShapesForZone(LaserZone& zone, deque<Shape*>& shapes);
+    Line* getTestPatternLine(const ofPoint& start, const ofPoint& end, const ofColor& col, const string& profilelabel);
+    Circle* getTestPatternCircle(const ofPoint& centre, float radius, const ofColor& col, const string& profilelabel);
+    Dot* getTestPatternDot(const ofPoint& pos, const ofColor& col, float intensity, const string& profilelabel);
     float getMoveDistanceForShapes(vector<PointsForShape>& shapes);
     float getMoveDistanceForShapes(vector<PointsForShape*>& shapes);
 
@@ -168,6 +164,10 @@ class Laser {
     ofParameter<int> syncShift;
     ofParameter<bool> sortShapes;
     ofParameter<bool> newShapeSortMethod;
+    // uses the ShapeSorter instead of the two methods above
+    ofParameter<bool> spatialShapeSort;
+    // skips the sort if the shapes haven't changed since last frame
+    ofParameter<bool> reuseShapeOrder;
     ofParameter<bool> alwaysClockwise;
     ofParameter<bool> smoothHomePosition;
     ofParameter<bool> laserOnWhileMoving = false;
@@ -182,6 +182,17 @@ class Laser {
     int frameTimeHistorySize = 200;
     float frameTimeHistory[200];
     int frameTimeHistoryOffset = 0;
+    uint64_t renderTimeMicros = 0;
+    float smoothedRenderTimeMicros = 0;
+    float smoothedSortTimeMicros = 0;
+    // the distance the laser moves between shapes in the last frame
+    float blankMoveDistance = 0;
+    // the number of times the per-frame point and shape buffers have had
+    // to grow. Once the frames settle down this should stop going up. It
+    // only watches those buffers, so it's not a count of every allocation
+    // (shapes, the sorter and the test patterns aren't included)
+    int bufferGrowthCount = 0;
+    int lastFrameBufferGrowth = 0;
     bool ignoreParamChange = false; 
 
     //-----------------------------------
@@ -202,13 +213,36 @@ class Laser {
     ofPoint laserHomePosition;
     
      
+    int countBufferGrowth();
+    
     vector<Point> laserPoints;
-    vector<Point> sparePoints;
-    vector<Point> sparePoints2;
+    
+    // buffers used to build each frame, kept between frames
+    vector<Point> pointArena;
+    vector<size_t> shapePieceSizes;
+    vector<PointsForShape> shapeSegments;
+    vector<PointsForShape*> sortedShapeSegments;
+    deque<Shape*> testPatternShapes;
+    deque<Shape*> zoneShapesWithTestPatternShapes;
+    // each laser has its own as they can be rendered at the same time
+    ShapeArena testPatternArena;
+    vector<ofPoint> testPatternPoints;
+    vector<ofColor> testPatternColours;
+    static const int numFrameBuffers = 5;
+    size_t frameBufferCapacities[numFrameBuffers] = {0,0,0,0,0};
+    // the colours of the last few points, for the colour shift. Big enough
+    // for the maximum shift at the maximum point rate.
+    static const int colourDelayBufferSize = 256;
+    glm::vec3 colourDelayBuffer[colourDelayBufferSize];
+    size_t colourDelayWriteIndex = 0;
     unsigned long frameCounter = 0;
     
     int numPoints;
     ofMesh previewPathMesh;
+    
+    ShapeSorter shapeSorter;
+    ShapeOrderCache shapeOrderCache;
+    OutputTransform outputTransform;
     ofEventListener paramsChangedListener;
 
     
@@ -51,6 +51,7 @@ ManagerBase :: ManagerBase() : dacAssigner(*DacAssigner::instance()) {
 ManagerBase :: ~ManagerBase() {
 	//ofLog(OF_LOG_NOTICE, "ofxLaser::Manager destructor");
 	saveSettings();
+	deleteAllRetainedShapes();
     
 //    // clean up
 //    for(Laser* laser : lasers) {
@@ -207,7 +208,9 @@ void ManagerBase::drawLine(const glm::vec3& start, const glm::vec3& end, const o
 	
 		
 	//Line l = new Line(gLProject(start), gLProject(end), ofFloatColor(col), 1, 1);
-	Line* l = new Line(gLProject(start), gLProject(end), col, profileLabel);
+	screenProjection.update();
+	Line* l = shapeArena.getLine();
+	l->init(screenProjection.project(start), screenProjection.project(end), col, profileLabel);
 	l->setTargetZone(targetZone); // only relevant for OFXLASER_ZONE_MANUAL
 	shapes.push_back(l);
 	
@@ -223,7 +226,9 @@ void ManagerBase::drawDot( const glm::vec2& p, const ofColor& col, float intensi
 }
 void ManagerBase::drawDot(const glm::vec3& p, const ofColor& col, float intensity, string profileLabel) {
 
-	Dot* d = new Dot(gLProject(p), col, intensity, profileLabel);
+	screenProjection.update();
+	Dot* d = shapeArena.getDot();
+	d->init(screenProjection.project(p), col, intensity, profileLabel);
 	d->setTargetZone(targetZone); // only relevant for OFXLASER_ZONE_MANUAL
 	shapes.push_back(d);
 }
@@ -239,13 +244,13 @@ void ManagerBase::drawPoly(const ofPolyline & poly, const ofColor& col, string p
 	ofPolyline& polyline = tmpPoly;
 	polyline = poly;
 	
-	for(glm::vec3& v : polyline.getVertices()) {
-		v = gLProject(v);
-	}
+	screenProjection.update();
+	screenProjection.project(polyline.getVertices());
 	
 	
 	
-	Polyline* p =new ofxLaser::Polyline(polyline, col, profileName);
+	Polyline* p = shapeArena.getPolyline();
+	p->init(polyline, col, profileName);
 	p->setTargetZone(targetZone); // only relevant for OFXLASER_ZONE_MANUAL
 	shapes.push_back(p);
 	
@@ -263,11 +268,11 @@ void ManagerBase::drawPoly(const ofPolyline & poly, std::vector<ofColor>& colour
 	ofPolyline& polyline = tmpPoly;
 	polyline = poly;
 	
-	for(glm::vec3& v : polyline.getVertices()) {
-		v = gLProject(v);
-	}
+	screenProjection.update();
+	screenProjection.project(polyline.getVertices());
 	
-	ofxLaser::Polyline* p =new ofxLaser::Polyline(polyline, colours, profileName);
+	ofxLaser::Polyline* p = shapeArena.getPolyline();
+	p->init(polyline, colours, profileName);
 	p->setTargetZone(targetZone); // only relevant for OFXLASER_ZONE_MANUAL
 	shapes.push_back(p);
 	
@@ -281,13 +286,14 @@ void ManagerBase::drawCircle(const glm::vec2& pos, const float& radius, const of
     drawCircle(glm::vec3(pos.x, pos.y, 0), radius, col, profileName);
 }
 void ManagerBase::drawCircle(const glm::vec3 & centre, const float& radius, const ofColor& col,string profileName){
-	ofxLaser::Circle* c = new ofxLaser::Circle(centre,radius, col, profileName);
+	ofxLaser::Circle* c = shapeArena.getCircle();
+	c->init(centre,radius, col, profileName);
 	c->setTargetZone(targetZone); // only relevant for OFXLASER_ZONE_MANUAL
     ofPolyline& polyline = c->polyline;
      
-    for(glm::vec3& v : polyline.getVertices()) {
-        v = gLProject(v);
-    }
+    screenProjection.update();
+    screenProjection.project(polyline.getVertices());
+    c->updateBoundingBox();
 	shapes.push_back(c);
 	
 }
@@ -307,17 +313,64 @@ void ManagerBase::drawLaserGraphic(Graphic& graphic, float brightness, string re
     
 }
 
+RetainedShape* ManagerBase::addRetainedPoly(const ofPolyline& poly, const ofColor& col, string profileName) {
+	RetainedShape* shape = new RetainedShape(poly, col, profileName);
+	shape->setTargetZone(targetZone); // only relevant for OFXLASER_ZONE_MANUAL
+	retainedShapes.push_back(shape);
+	return shape;
+}
+
+RetainedShape* ManagerBase::addRetainedPoly(const ofPolyline& poly, const vector<ofColor>& colours, string profileName) {
+	RetainedShape* shape = new RetainedShape(poly, colours, profileName);
+	shape->setTargetZone(targetZone); // only relevant for OFXLASER_ZONE_MANUAL
+	retainedShapes.push_back(shape);
+	return shape;
+}
+
+RetainedShape* ManagerBase::addRetainedLine(const glm::vec2& start, const glm::vec2& end, const ofColor& col, string profileName) {
+	ofPolyline& polyline = tmpPoly;
+	polyline.clear();
+	polyline.addVertex(start.x, start.y);
+	polyline.addVertex(end.x, end.y);
+	return addRetainedPoly(polyline, col, profileName);
+}
+
+RetainedShape* ManagerBase::addRetainedCircle(const glm::vec2& centre, float radius, const ofColor& col, string profileName) {
+	// same as the Circle shape, a little bit of overlap at the ends
+	ofPolyline& polyline = tmpPoly;
+	polyline.clear();
+	for(int angle = -1; angle<=361; angle++) {
+		glm::vec3 p = glm::rotateZ(glm::vec3(radius, 0, 0), ofDegToRad(angle));
+		polyline.addVertex(p + glm::vec3(centre.x, centre.y, 0));
+	}
+	return addRetainedPoly(polyline, col, profileName);
+}
+
+bool ManagerBase::deleteRetainedShape(RetainedShape* shape) {
+	auto it = std::find(retainedShapes.begin(), retainedShapes.end(), shape);
+	if(it==retainedShapes.end()) return false;
+	retainedShapes.erase(it);
+	delete shape;
+	return true;
+}
+
+void ManagerBase::deleteAllRetainedShapes() {
+	for(RetainedShape* shape : retainedShapes) {
+		delete shape;
+	}
+	retainedShapes.clear();
+}
+
 void ManagerBase:: update(){
 	if(doArmAll) armAllLasers();
 	if(doDisarmAll) disarmAllLasers();
 	zonesChanged = false;
 	
 	if(useBitmapMask) laserMask.update();
-	// delete all the shapes - all shape objects need a destructor!
-	for(size_t i= 0; i<shapes.size(); i++) {
-		delete shapes[i];
-	}
+	// the shapes aren't deleted, they're kept in the arena to reuse
 	shapes.clear();
+	shapeArena.reset();
+	shapesToSend.clear();
 	
 	// updates all the zones. If zone->update returns true, then
 	// it means that the zone has changed.
@@ -376,45 +429,61 @@ void ManagerBase::send(){
 	// and send them. When the zones get the shape, they transform them
 	// into local zone space.
 	
+	shapesToSend.assign(shapes.begin(), shapes.end());
+	for(RetainedShape* retainedShape : retainedShapes) {
+		// only recalculates the shape if it's changed
+		Shape* s = retainedShape->getShape();
+		if(s!=NULL) shapesToSend.push_back(s);
+	}
+	
 	if(zoneMode!=OFXLASER_ZONE_OPTIMISE) {
-		for(size_t j = 0; j<zones.size(); j++) {
-			Zone& z = *zones[j];
-			z.shapes.clear();
+		for(Zone* zone : zones) zone->shapes.clear();
+		
+		if(zoneMode == OFXLASER_ZONE_AUTOMATIC) {
+			// the grid tells us which zones each shape could be in
+			// so we don't have to test every zone
+			zoneRects.resize(zones.size());
+			for(size_t j = 0; j<zones.size(); j++) zoneRects[j] = zones[j]->rect;
+			zoneGrid.update(zoneRects, ofRectangle(0, 0, width, height));
 			
-			for(size_t i= 0; i<shapes.size(); i++) {
-				Shape* s = shapes[i];
-				// if (zone should have shape) then
-				// TODO zone intersect shape test
-				if(zoneMode == OFXLASER_ZONE_AUTOMATIC) {
-					bool shapeAdded = z.addShape(s);
-				} else if(zoneMode == OFXLASER_ZONE_MANUAL) {
-					if(s->getTargetZone() == (int)j) z.addShape(s);
+			for(size_t i= 0; i<shapesToSend.size(); i++) {
+				Shape* s = shapesToSend[i];
+				for(int j : zoneGrid.getZonesForRect(s->getBoundingBox())) {
+					zones[j]->addShape(s);
 				}
 			}
+		} else if(zoneMode == OFXLASER_ZONE_MANUAL) {
+			for(size_t i= 0; i<shapesToSend.size(); i++) {
+				Shape* s = shapesToSend[i];
+				int j = s->getTargetZone();
+				if((j>=0) && (j<(int)zones.size())) zones[j]->addShape(s);
+			}
 		}
 	} else {
-		// TODO : 	OPTIMISE ALGORITHM GOES HERE
-		// figure out which shapes are in each zone
-		// if a shape is entirely enclosed in a zone, then
-		// mark the shape as such
-		// if a shape is partially enclosed in a zone then
-		// mark it as such
-		
-		// LOGIC IS AS FOLLOWS :
-		// if a shape is entirely in one or more zones, then :
-		// put it in the zone with the nearest other shape
-		// UNLESS that zone already has too many shapes (greater than half
-		// if we're dealing with two zones)
-		// IF the shape is only in that zone, and it is already full, have
-		// a look through the other shapes in the zone
-		// 		IF the shape is in another zone
-		// 			FIND the zone that
-		//				a) has the nearest other shape
-		//				b) AND isn't too full
-		
-		
-		
+		// shapes that are inside more than one zone go to the laser
+		// that has the most points to spare
+		zoneRects.resize(zones.size());
+		zoneLasers.resize(zones.size());
+		for(size_t j = 0; j<zones.size(); j++) {
+			zoneRects[j] = zones[j]->rect;
+			zoneLasers[j].clear();
+			for(size_t i = 0; i<lasers.size(); i++) {
+				LaserZone* laserZone = lasers[i]->getLaserZoneForZone(zones[j]);
+				if((laserZone!=NULL) && laserZone->getVisible()) zoneLasers[j].push_back((int)i);
+			}
+		}
+		laserBudgets.resize(lasers.size());
+		for(size_t i = 0; i<lasers.size(); i++) laserBudgets[i] = lasers[i]->getPointBudget();
 		
+		zoneBalancer.setZones(zoneRects, zoneLasers);
+		zoneBalancer.setLaserBudgets(laserBudgets);
+		zoneBalancer.assignShapes(shapesToSend, [&](Shape& shape, int laserindex) {
+			return lasers[laserindex]->getPointEstimate(shape);
+		});
+		for(size_t j = 0; j<zones.size(); j++) {
+			const vector<Shape*>& zoneshapes = zoneBalancer.getShapesForZone((int)j);
+			zones[j]->shapes.assign(zoneshapes.begin(), zoneshapes.end());
+		}
 	}
 	
 	// 2 :
@@ -425,13 +494,39 @@ void ManagerBase::send(){
 	// So - the shapes need to be sorted in output space but their points need to be
 	// calculated at zone space. Otherwise the perspective distortion won't look right in
 	// terms of brightness distribution.
-	for(size_t i= 0; i<lasers.size(); i++) {
-		
-		Laser& p = *lasers[i];
-		
-		p.send(useBitmapMask?laserMask.getPixels():NULL, globalBrightness);
+	uint64_t sendStartTime = ofGetElapsedTimeMicros();
+	BitmapMaskManager* bitmapMask = useBitmapMask ? &laserMask : NULL;
+	
+	// Each laser renders its own frame and only reads the shared shapes, so
+	// if we have more than one, they can be rendered at the same time.
+	if(renderInParallel && (lasers.size()>1)) {
+		if(renderThreadPool.getNumThreads()==0) renderThreadPool.setNumThreads();
+		renderThreadPool.run((int)lasers.size(), [&](int i) {
+			lasers[i]->render(bitmapMask, globalBrightness);
+		});
+		// the DACs aren't thread safe so they all get their frames from here
+		for(Laser* laser : lasers) laser->sendRenderedFrame();
 		
+	} else {
+		for(size_t i= 0; i<lasers.size(); i++) {
+			
+			Laser& p = *lasers[i];
+			
+			p.send(bitmapMask, globalBrightness);
+			
+		}
 	}
+	float sendTimeMicros = ofGetElapsedTimeMicros() - sendStartTime;
+	smoothedSendTimeMicros += (sendTimeMicros - smoothedSendTimeMicros)*0.1;
+}
+
+float ManagerBase :: getSendTimeMillis() {
+	return smoothedSendTimeMicros/1000.0f;
+}
+
+int ManagerBase :: getNumRenderThreads() {
+	// the calling thread also renders
+	return renderInParallel ? renderThreadPool.getNumThreads()+1 : 1;
 }
 
 
@@ -479,6 +574,7 @@ void ManagerBase::initAndLoadSettings() {
 	interfaceParams.add(lockInputZones.set("Lock input zones", true));
 	interfaceParams.add(showInputPreview.set("Show preview", true));
 	interfaceParams.add(showOutputPreviews.set("Show path previews", true));
+	interfaceParams.add(renderInParallel.set("Render lasers in parallel", false));
 	//interfaceParams.add(useBitmapMask.set("Use bitmap mask", false));
 	//interfaceParams.add(showBitmapMask.set("Show bitmap mask", false));
 	//interfaceParams.add(laserMasks.set("Laser mask shapes", false));
@@ -636,26 +732,8 @@ ofPoint ManagerBase::gLProject(ofPoint p) {
 }
 ofPoint ManagerBase::gLProject( float x, float y, float z ) {
 	
-    ofRectangle rViewport = ofGetCurrentViewport();
-	
-	glm::mat4 modelview, projection;
-	glGetFloatv(GL_MODELVIEW_MATRIX, glm::value_ptr(modelview));
-	glGetFloatv(GL_PROJECTION_MATRIX, glm::value_ptr(projection));
-	glm::mat4 mat = ofGetCurrentOrientationMatrix();
-	mat = glm::inverse(mat);
-	mat *=projection * modelview;
-	glm::vec4 dScreen4 = mat * glm::vec4(x,y,z,1.0);
-	glm::vec3 dScreen = glm::vec3(dScreen4) / dScreen4.w;
-	dScreen += glm::vec3(1.0) ;
-	dScreen *= 0.5;
-	
-	dScreen.x *= rViewport.width;
-	dScreen.x += rViewport.x;
-	
-	dScreen.y *= rViewport.height;
-	dScreen.y += rViewport.y;
-
-    return ofPoint(dScreen.x, dScreen.y, 0.0f);// - offset;
+	screenProjection.update();
+	return screenProjection.project(glm::vec3(x, y, z));
 	
 }
 
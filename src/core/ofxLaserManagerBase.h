@@ -16,11 +16,17 @@
 #include "ofxLaserLine.h"
 #include "ofxLaserPolyline.h"
 #include "ofxLaserCircle.h"
+#include "ofxLaserRetainedShape.h"
+#include "ofxLaserShapeArena.h"
+#include "ofxLaserScreenProjection.h"
+#include "ofxLaserZoneGrid.h"
+#include "ofxLaserZoneBalancer.h"
 #include "ofxLaserDacBase.h"
 #include "ofxLaserBitmapMaskManager.h"
 #include "ofxLaserGraphic.h"
 #include "ofxLaserLaser.h"
 #include "ofxLaserPresetManager.h"
+#include "ofxLaserRenderThreadPool.h"
 
 
 
@@ -28,7 +34,7 @@ enum ofxLaserZoneMode {
     OFXLASER_ZONE_MANUAL, // all zones are separate, you manually specify which zone you want
     OFXLASER_ZONE_AUTOMATIC, // non-overlapping zones assumed - shapes go in all zones that
     // contain it
-    OFXLASER_ZONE_OPTIMISE // automatically puts it in the best zone -- NOT CURRENTLY IMPLEMENTED
+    OFXLASER_ZONE_OPTIMISE // shapes inside more than one zone go to the laser with the most points to spare
 };
 
 namespace ofxLaser {
@@ -72,6 +78,11 @@ class ManagerBase {
     bool saveSettings();
     
     void send();
+    // smoothed time taken to render and send all the lasers, in milliseconds
+    float getSendTimeMillis();
+    int getNumRenderThreads();
+    // for the shape allocation stats
+    const ShapeArena& getShapeArena() { return shapeArena; };
     void sendRawPoints(const std::vector<ofxLaser::Point>& points, int lasernum = 0, int zonenum = 0);
     
     int getLaserPointRate(unsigned int lasernum = 0);
@@ -100,6 +111,16 @@ class ManagerBase {
    
     void drawLaserGraphic(Graphic& graphic, float brightness = 1, string renderProfile = OFXLASER_PROFILE_DEFAULT);
     
+    // retained shapes are drawn every frame until they're deleted. Keep the
+    // pointer that's returned to change the shape.
+    RetainedShape* addRetainedPoly(const ofPolyline& poly, const ofColor& col, string profileName = OFXLASER_PROFILE_DEFAULT);
+    RetainedShape* addRetainedPoly(const ofPolyline& poly, const vector<ofColor>& colours, string profileName = OFXLASER_PROFILE_DEFAULT);
+    RetainedShape* addRetainedLine(const glm::vec2& start, const glm::vec2& end, const ofColor& col, string profileName = OFXLASER_PROFILE_DEFAULT);
+    RetainedShape* addRetainedCircle(const glm::vec2& centre, float radius, const ofColor& col, string profileName = OFXLASER_PROFILE_DEFAULT);
+    bool deleteRetainedShape(RetainedShape* shape);
+    void deleteAllRetainedShapes();
+    int getNumRetainedShapes() { return (int)retainedShapes.size(); };
+    
     vector<Laser*>& getLasers();
     Laser& getLaser(int index = 0);
     int getNumLasers() { return (int)lasers.size(); };
@@ -146,6 +167,7 @@ class ManagerBase {
     ofParameter<bool> useBitmapMask;
     ofParameter<bool> showBitmapMask;
     ofParameter<bool> laserMasks;
+    ofParameter<bool> renderInParallel;
     ofParameter<int> numLasers; // << not used except for load / save
     
     float defaultHandleSize = 10;
@@ -182,10 +204,29 @@ class ManagerBase {
     
     std::vector<Laser*> lasers;
     
-    std::deque <ofxLaser::Shape*> shapes;
+    // a vector rather than a deque so that clearing it keeps the memory
+    std::vector <ofxLaser::Shape*> shapes;
+    std::vector<RetainedShape*> retainedShapes;
+    // the shapes from the draw functions are stored here
+    ShapeArena shapeArena;
+    // this frame's shapes and the visible retained shapes
+    std::vector<ofxLaser::Shape*> shapesToSend;
+    
+    // to find which zones each shape could be in
+    ZoneGrid zoneGrid;
+    std::vector<ofRectangle> zoneRects;
+    // for OFXLASER_ZONE_OPTIMISE
+    ZoneBalancer zoneBalancer;
+    std::vector<std::vector<int>> zoneLasers;
+    std::vector<float> laserBudgets;
     //ofParameter<int> testPattern;
     
     ofPolyline tmpPoly; // to avoid generating polyline objects
+    // converts the draw coordinates into canvas space
+    ScreenProjection screenProjection;
+    
+    RenderThreadPool renderThreadPool;
+    float smoothedSendTimeMicros = 0;
     
     private:
 };
@@ -7,6 +7,7 @@
 
 
 #include "ofxLaserMaskManager.h"
+#include <unordered_map>
 
 
 using namespace ofxLaser;
@@ -127,6 +128,191 @@ vector<ofPolyline*>  MaskManager  ::getLaserMaskShapes(){
     
 }
 
+void MaskManager::applyQuadMasks(Point* points, size_t count) {
+    
+    if(quads.empty() || (count==0)) return;
+    
+    if(checkRasterChanged()) updateRaster();
+    
+    if(!rasterValid) {
+        for(size_t i = 0; i<count; i++) applyQuadMasksExact(points[i]);
+        return;
+    }
+    
+    float cellScale = 1.0f/rasterCellSize;
+    for(size_t i = 0; i<count; i++) {
+        Point& p = points[i];
+        if((p.x>=0) && (p.y>=0)) {
+            int column = (int)(p.x*cellScale);
+            int row = (int)(p.y*cellScale);
+            if((column<rasterColumns) && (row<rasterRows)) {
+                int cell = rasterCells[column + (row*rasterColumns)];
+                if(cell==0) continue;
+                if(cell>0) {
+                    for(int maskindex : rasterCombinations[cell]) {
+                        p.multiplyColour(ofMap(quads[maskindex]->maskLevel,100,0,0,1));
+                    }
+                    continue;
+                }
+            }
+        }
+        applyQuadMasksExact(p);
+    }
+}
+
+void MaskManager::applyQuadMasksExact(Point& p) {
+    for(QuadMask* mask : quads){
+        if(mask->hitTest(p)) {
+            p.multiplyColour(ofMap(mask->maskLevel,100,0,0,1));
+        }
+    }
+}
+
+bool MaskManager::checkRasterChanged() {
+    
+    // the masks can be changed from lots of places and their dirty flags
+    // get cleared when they're drawn, so just compare everything that the
+    // hit test uses. It's only a few numbers per mask.
+    newRasterSignature.clear();
+    newRasterSignature.push_back(width);
+    newRasterSignature.push_back(height);
+    newRasterSignature.push_back(rasterCellSize);
+    for(QuadMask* mask : quads) {
+        for(glm::vec3& vertex : mask->quadPoly.getVertices()) {
+            newRasterSignature.push_back(vertex.x);
+            newRasterSignature.push_back(vertex.y);
+        }
+        newRasterSignature.push_back(mask->boundingBox.x);
+        newRasterSignature.push_back(mask->boundingBox.y);
+        newRasterSignature.push_back(mask->boundingBox.width);
+        newRasterSignature.push_back(mask->boundingBox.height);
+        newRasterSignature.push_back(mask->maskLevel);
+    }
+    if(newRasterSignature==rasterSignature) return false;
+    
+    rasterSignature.swap(newRasterSignature);
+    return true;
+}
+
+// true if the line from a to b touches the rectangle
+static bool lineTouchesRect(const glm::vec3& a, const glm::vec3& b, float left, float top, float right, float bottom) {
+    
+    float t0 = 0;
+    float t1 = 1;
+    float dx = b.x-a.x;
+    float dy = b.y-a.y;
+    float p[4] = {-dx, dx, -dy, dy};
+    float q[4] = {a.x-left, right-a.x, a.y-top, bottom-a.y};
+    for(int i = 0; i<4; i++) {
+        if(p[i]==0) {
+            if(q[i]<0) return false;
+        } else {
+            float t = q[i]/p[i];
+            if(p[i]<0) t0 = MAX(t0, t);
+            else t1 = MIN(t1, t);
+            if(t0>t1) return false;
+        }
+    }
+    return true;
+}
+
+void MaskManager::updateRaster() {
+    
+    rasterValid = false;
+    rasterCombinations.clear();
+    // the combination for cells with no masks
+    rasterCombinations.push_back(vector<int>());
+    
+    // one bit per mask, so if there are too many masks or no area just
+    // hit test everything
+    if((quads.size()>64) || (width<=0) || (height<=0) || (rasterCellSize<=0)) return;
+    
+    rasterColumns = ceil(width/rasterCellSize);
+    rasterRows = ceil(height/rasterCellSize);
+    int numCells = rasterColumns*rasterRows;
+    
+    vector<uint64_t> cellMasks(numCells, 0);
+    vector<char> cellEdges(numCells, 0);
+    
+    // points within this distance of an edge always get hit tested so that
+    // rounding can't make a difference
+    float margin = 0.01f;
+    
+    for(size_t m = 0; m<quads.size(); m++) {
+        QuadMask& mask = *quads[m];
+        vector<glm::vec3>& vertices = mask.quadPoly.getVertices();
+        
+        ofRectangle& bounds = mask.boundingBox;
+        int firstcolumn = ofClamp(floor((bounds.getLeft()-margin)/rasterCellSize), 0, rasterColumns);
+        int lastcolumn = ofClamp(floor((bounds.getRight()+margin)/rasterCellSize), -1, rasterColumns-1);
+        int firstrow = ofClamp(floor((bounds.getTop()-margin)/rasterCellSize), 0, rasterRows);
+        int lastrow = ofClamp(floor((bounds.getBottom()+margin)/rasterCellSize), -1, rasterRows-1);
+        
+        // mark the cells that the edges go through
+        for(size_t i = 0; i+1<vertices.size(); i++) {
+            const glm::vec3& a = vertices[i];
+            const glm::vec3& b = vertices[i+1];
+            int c1 = ofClamp(floor((MIN(a.x,b.x)-margin)/rasterCellSize), 0, rasterColumns);
+            int c2 = ofClamp(floor((MAX(a.x,b.x)+margin)/rasterCellSize), -1, rasterColumns-1);
+            int r1 = ofClamp(floor((MIN(a.y,b.y)-margin)/rasterCellSize), 0, rasterRows);
+            int r2 = ofClamp(floor((MAX(a.y,b.y)+margin)/rasterCellSize), -1, rasterRows-1);
+            for(int row = r1; row<=r2; row++) {
+                for(int column = c1; column<=c2; column++) {
+                    float left = (column*rasterCellSize)-margin;
+                    float top = (row*rasterCellSize)-margin;
+                    if(lineTouchesRect(a, b, left, top, left+rasterCellSize+(margin*2), top+rasterCellSize+(margin*2))) {
+                        cellEdges[column+(row*rasterColumns)] = true;
+                    }
+                }
+            }
+        }
+        
+        // any run of cells along a row without an edge in it must be either
+        // all inside or all outside, so we only need to test one cell
+        for(int row = firstrow; row<=lastrow; row++) {
+            bool runTested = false;
+            bool runInside = false;
+            for(int column = firstcolumn; column<=lastcolumn; column++) {
+                int cell = column+(row*rasterColumns);
+                if(cellEdges[cell]) {
+                    runTested = false;
+                    continue;
+                }
+                if(!runTested) {
+                    ofPoint centre((column+0.5f)*rasterCellSize, (row+0.5f)*rasterCellSize);
+                    runInside = mask.hitTest(centre);
+                    runTested = true;
+                }
+                if(runInside) cellMasks[cell] |= ((uint64_t)1<<m);
+            }
+        }
+    }
+    
+    // give each different set of masks an index
+    std::unordered_map<uint64_t, int> combinationIndices;
+    combinationIndices[0] = 0;
+    rasterCells.resize(numCells);
+    for(int cell = 0; cell<numCells; cell++) {
+        if(cellEdges[cell]) {
+            rasterCells[cell] = -1;
+            continue;
+        }
+        uint64_t bits = cellMasks[cell];
+        auto it = combinationIndices.find(bits);
+        if(it==combinationIndices.end()) {
+            vector<int> masks;
+            for(size_t m = 0; m<quads.size(); m++) {
+                if(bits & ((uint64_t)1<<m)) masks.push_back((int)m);
+            }
+            it = combinationIndices.emplace(bits, (int)rasterCombinations.size()).first;
+            rasterCombinations.push_back(masks);
+        }
+        rasterCells[cell] = it->second;
+    }
+    rasterValid = true;
+    
+}
+
 void MaskManager::serialize(ofJson&json) {
     
     // create an empty json object
@@ -37,15 +37,43 @@ public:
 	vector<ofPolyline*> getLaserMaskShapes();
     QuadMask& addQuadMask(int level=100);
     
+    // reduces the brightness of any points that are inside the quad masks.
+    // The masks are rasterised into a grid of cells so most points only
+    // need a single lookup. Points in cells that have a mask edge going
+    // through them (or that are outside the grid) are hit tested against
+    // the quads in exactly the same way as before, so the result is the same.
+    void applyQuadMasks(Point* points, size_t count);
+    
     vector<QuadMask*> quads;
     
 	int width, height; 
 	
+    // the size of each cell in the mask raster in pixels
+    float rasterCellSize = 4;
+    
     protected :
     bool dirty;
 	ofPoint offset;
 	float scale = 1;
    // bool firstUpdate = true; 
     
+    void updateRaster();
+    bool checkRasterChanged();
+    void applyQuadMasksExact(Point& p);
+    
+    // for each cell, -1 if a mask edge goes through it, otherwise the
+    // index into rasterCombinations for the masks that cover it
+    vector<int> rasterCells;
+    // the indices of the masks that cover each kind of cell, in order
+    vector<vector<int>> rasterCombinations;
+    int rasterColumns = 0;
+    int rasterRows = 0;
+    bool rasterValid = false;
+    
+    // the mask shapes and levels that the raster was made from, so we
+    // can tell when it needs updating
+    vector<float> rasterSignature;
+    vector<float> newRasterSignature;
+    
 };
 }
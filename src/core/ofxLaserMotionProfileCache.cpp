@@ -0,0 +1,123 @@
+//
+//  ofxLaserMotionProfileCache.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserMotionProfileCache.h"
+
+using namespace ofxLaser;
+
+size_t MotionProfileCache :: KeyHash :: operator()(const Key& key) const {
+    size_t hash = std::hash<int64_t>()(key.length);
+    hash ^= std::hash<float>()(key.acceleration) + 0x9e3779b9 + (hash<<6) + (hash>>2);
+    hash ^= std::hash<float>()(key.speed) + 0x9e3779b9 + (hash<<6) + (hash>>2);
+    hash ^= std::hash<float>()(key.speedMultiplier) + 0x9e3779b9 + (hash<<6) + (hash>>2);
+    return hash;
+}
+
+std::shared_ptr<const vector<float>> MotionProfileCache :: getUnitDistances(float distance, float acceleration, float speed, float speedMultiplier) {
+    
+    Key key;
+    key.length = llround(distance/lengthResolution);
+    key.acceleration = acceleration;
+    key.speed = speed;
+    key.speedMultiplier = speedMultiplier;
+    
+    // anything that rounds down to nothing gets calculated as it is
+    if(key.length<=0) {
+        missCount++;
+        auto unitdistances = std::make_shared<vector<float>>();
+        calculateUnitDistances(*unitdistances, distance, acceleration, speed, speedMultiplier);
+        return unitdistances;
+    }
+    
+    auto it = tables.find(key);
+    if(it!=tables.end()) {
+        hitCount++;
+        return it->second;
+    }
+    
+    missCount++;
+    
+    // the simplest way to keep the memory bounded is to start again
+    // when it gets too full
+    if(storedValueCount>maxStoredValues) clear();
+    
+    // use the rounded length so the result is the same whichever
+    // length got here first
+    auto unitdistances = std::make_shared<vector<float>>();
+    calculateUnitDistances(*unitdistances, key.length*lengthResolution, acceleration, speed, speedMultiplier);
+    storedValueCount+=unitdistances->size();
+    tables[key] = unitdistances;
+    return unitdistances;
+    
+}
+
+void MotionProfileCache :: clear() {
+    tables.clear();
+    storedValueCount = 0;
+}
+
+float MotionProfileCache :: getHitRate() {
+    uint64_t total = hitCount+missCount;
+    return (total>0) ? (float)hitCount/(float)total : 0;
+}
+
+void MotionProfileCache :: calculateUnitDistances(vector<float>& unitDistances, float distance, float acceleration, float speed, float speedMultiplier){
+    
+    speed*=speedMultiplier;
+    acceleration*=speedMultiplier;
+    unitDistances.clear();
+    
+    float acceleratedistance = (speed*speed) / (2*acceleration);
+    float timetogettospeed = speed / acceleration;
+    
+    float totaldistance = distance;
+    
+    float constantspeeddistance = totaldistance - (acceleratedistance*2);
+    float constantspeedtime = constantspeeddistance/speed;
+    
+    if(totaldistance<(acceleratedistance*2)) {
+        
+        constantspeeddistance = 0 ;
+        constantspeedtime = 0;
+        acceleratedistance = totaldistance/2;
+        speed = sqrt( acceleratedistance * 2 * acceleration);
+        timetogettospeed = speed / acceleration;
+        
+    }
+    
+    float totaltime = (timetogettospeed*2) + constantspeedtime;
+    
+    float timeincrement = totaltime / (floor(totaltime));
+    
+    float currentdistance;
+    
+    float t = 0;
+    
+    while (t <= totaltime + 0.001) {
+        
+        if(t>totaltime) t = totaltime;
+        
+        if(t <=timetogettospeed) {
+            currentdistance = 0.5 * acceleration * (t*t);
+            
+        } else if((t>timetogettospeed) && (t<=timetogettospeed+constantspeedtime)){
+            currentdistance = acceleratedistance + ((t-timetogettospeed) * speed);
+            
+        } else  {
+            float t3 = t - (timetogettospeed + constantspeedtime);
+            
+            currentdistance = (acceleratedistance + constantspeeddistance) + (speed*t3)+(0.5 *(-acceleration) * (t3*t3));
+            
+            
+        }
+        
+        unitDistances.push_back(currentdistance/totaldistance);
+        
+        t+=timeincrement;
+        
+    }
+    
+}
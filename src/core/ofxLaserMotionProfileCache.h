@@ -0,0 +1,63 @@
+//
+//  ofxLaserMotionProfileCache.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+#include <unordered_map>
+
+namespace ofxLaser {
+
+// Works out how far along a straight run each point should be so that the
+// scanners accelerate, move at a constant speed and then decelerate (a
+// trapezoidal speed profile). The results only depend on the length of the
+// run and the speed settings, and lots of shapes (text, hatching) have runs
+// that are the same length, so each result is stored and shared.
+//
+// Each laser has its own render profiles, and each render profile has its
+// own cache, so only one thread uses a cache at a time. The tables themselves
+// never change once they're made, and they're handed out as shared pointers
+// so they stay valid even if the cache is cleared.
+class MotionProfileCache {
+    
+    public :
+    
+    // returns the unit distances (0 to 1) along a run of the given length.
+    std::shared_ptr<const vector<float>> getUnitDistances(float distance, float acceleration, float speed, float speedMultiplier);
+    
+    // does the calculation without the cache
+    static void calculateUnitDistances(vector<float>& unitdistances, float distance, float acceleration, float speed, float speedMultiplier);
+    
+    void clear();
+    float getHitRate();
+    
+    // lengths are rounded to this before they're looked up
+    float lengthResolution = 0.01;
+    // the cache is emptied if it gets bigger than this many values
+    size_t maxStoredValues = 1<<20;
+    
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+    
+    protected :
+    
+    struct Key {
+        int64_t length;
+        float acceleration;
+        float speed;
+        float speedMultiplier;
+        bool operator==(const Key& other) const {
+            return (length==other.length) && (acceleration==other.acceleration) && (speed==other.speed) && (speedMultiplier==other.speedMultiplier);
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    
+    std::unordered_map<Key, std::shared_ptr<const vector<float>>, KeyHash> tables;
+    size_t storedValueCount = 0;
+    
+};
+}
@@ -0,0 +1,80 @@
+//
+//  ofxLaserOutputTransform.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserOutputTransform.h"
+
+using namespace ofxLaser;
+
+void OutputTransform :: set(const glm::vec2& offset, bool flipx, bool flipy, float rotationdegrees, float size) {
+
+    outputSize = size;
+    float centre = size/2;
+
+    // build it up in doubles so that the rounding is as close as possible
+    // to doing each step separately
+    // x' = a*x + b*y + c
+    // y' = d*x + e*y + f
+    double a = 1, b = 0, c = offset.x;
+    double d = 0, e = 1, f = offset.y;
+
+    if(flipy) {
+        d = -d;
+        e = -e;
+        f = size-f;
+    }
+    if(flipx) {
+        a = -a;
+        b = -b;
+        c = size-c;
+    }
+    if(rotationdegrees!=0) {
+        double angle = ofDegToRad(rotationdegrees);
+        double cosine = cos(angle);
+        double sine = sin(angle);
+        // move to the centre, rotate, then move back
+        c-=centre;
+        f-=centre;
+        double na = (cosine*a) - (sine*d);
+        double nb = (cosine*b) - (sine*e);
+        double nc = (cosine*c) - (sine*f);
+        double nd = (sine*a) + (cosine*d);
+        double ne = (sine*b) + (cosine*e);
+        double nf = (sine*c) + (cosine*f);
+        a = na; b = nb; c = nc + centre;
+        d = nd; e = ne; f = nf + centre;
+    }
+
+    matrix[0] = a;
+    matrix[1] = b;
+    matrix[2] = c;
+    matrix[3] = d;
+    matrix[4] = e;
+    matrix[5] = f;
+    identity = (a==1) && (b==0) && (c==0) && (d==0) && (e==1) && (f==0);
+
+}
+
+void OutputTransform :: apply(Point* points, size_t count) {
+
+    const float m0 = matrix[0], m1 = matrix[1], m2 = matrix[2];
+    const float m3 = matrix[3], m4 = matrix[4], m5 = matrix[5];
+    const float size = outputSize;
+
+    for(size_t i = 0; i<count; i++) {
+        Point& p = points[i];
+
+        float x = (m0*p.x) + (m1*p.y) + m2;
+        float y = (m3*p.x) + (m4*p.y) + m5;
+
+        // bounds check
+        bool outside = (x<0) || (x>size) || (y<0) || (y>size);
+        p.x = ofClamp(x, 0, size);
+        p.y = ofClamp(y, 0, size);
+        if(outside) {
+            p.r = p.g = p.b = 0;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+//  ofxLaserOutputTransform.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLaserPoint.h"
+
+namespace ofxLaser {
+
+// The final adjustments to a laser's output - the position offset, the
+// horizontal and vertical flips and the rotation - combined into a single
+// 2D affine transform. It's worked out once per frame rather than checking
+// each setting for every point.
+class OutputTransform {
+
+    public :
+
+    // applied in the same order as before : offset, flip vertical, flip
+    // horizontal, then rotation around the centre of the output area
+    void set(const glm::vec2& offset, bool flipx, bool flipy, float rotationdegrees, float size = 800);
+
+    // transforms the points in place and then clamps them to the output
+    // area, any points outside are moved to the edge and blanked.
+    void apply(Point* points, size_t count);
+
+    glm::vec2 getTransformed(const glm::vec2& p) const {
+        return glm::vec2((matrix[0]*p.x) + (matrix[1]*p.y) + matrix[2], (matrix[3]*p.x) + (matrix[4]*p.y) + matrix[5]);
+    }
+
+    bool isIdentity() const { return identity; };
+
+    protected :
+
+    // row major, the bottom row is always 0, 0, 1
+    float matrix[6] = {1,0,0, 0,1,0};
+    bool identity = true;
+    float outputSize = 800;
+
+};
+}
@@ -0,0 +1,66 @@
+//
+//  ofxLaserPointsForShape.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofxLaserPoint.h"
+
+namespace ofxLaser {
+
+// holds all the points for a shape segment. The points themselves live in
+// a big vector of points for the whole frame (the laser's point arena), this
+// just knows where they start and how many there are. Using an index rather
+// than a pointer means it stays valid if the arena grows.
+class PointsForShape {
+    
+    public:
+    
+    PointsForShape() {};
+    PointsForShape(vector<Point>* pointarena, size_t startoffset, size_t numpoints) {
+        arena = pointarena;
+        offset = startoffset;
+        length = numpoints;
+    }
+    
+    bool tested = false;
+    bool reversed = false;
+    bool reversable = true;
+    
+    size_t size() const { return length; }
+    bool empty() const { return length==0; }
+    
+    Point& operator[](size_t index) { return (*arena)[offset+index]; }
+    Point& front() { return (*arena)[offset]; }
+    Point& back() { return (*arena)[offset+length-1]; }
+    Point* begin() { return arena->data()+offset; }
+    Point* end() { return arena->data()+offset+length; }
+    
+    Point& getStart() {
+        return reversed?this->back() : this->front();
+    }
+    Point& getEnd() {
+        return reversed?this->front() : this->back();
+    }
+    
+    glm::vec3 getStartGlm() {
+        glm::vec3 p;
+        p.x = reversed ? this->back().x : this->front().x;
+        p.y = reversed ? this->back().y : this->front().y;
+        return p;
+    }
+    glm::vec3 getEndGlm() {
+        glm::vec3 p;
+        p.x = reversed ? this->front().x : this->back().x;
+        p.y = reversed ? this->front().y : this->back().y;
+        return p;
+    }
+    
+    vector<Point>* arena = nullptr;
+    size_t offset = 0;
+    size_t length = 0;
+    
+};
+
+}
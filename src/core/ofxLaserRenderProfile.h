@@ -7,6 +7,7 @@
 //
 #pragma once
 #include "ofMain.h"
+#include "ofxLaserMotionProfileCache.h"
 
 namespace ofxLaser {
 
@@ -44,6 +45,11 @@ namespace ofxLaser {
 		ofParameter<int> dotMaxPoints;
 		
 		ofParameterGroup params;
+		
+		// mutable because shapes are given a const profile and the cache
+		// doesn't change the output
+		mutable MotionProfileCache motionProfileCache;
+		
         private :
         string label;
 
@@ -0,0 +1,111 @@
+//
+//  ofxLaserRenderThreadPool.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserRenderThreadPool.h"
+
+using namespace ofxLaser;
+
+RenderThreadPool :: RenderThreadPool() {
+    nextTaskIndex = 0;
+}
+
+RenderThreadPool :: ~RenderThreadPool() {
+    stopThreads();
+}
+
+void RenderThreadPool :: setNumThreads(int numthreads) {
+    if(numthreads<=0) {
+        numthreads = MAX(1, (int)std::thread::hardware_concurrency()-1);
+    }
+    if(numthreads == (int)workers.size()) return;
+
+    stopThreads();
+
+    stopping = false;
+    // the threads are given the current generation rather than reading it
+    // when they start, otherwise one that starts after the next run() has
+    // begun would miss it and run() would wait for it forever
+    for(int i = 0; i<numthreads; i++) {
+        workers.emplace_back(&RenderThreadPool::workerFunction, this, generation);
+    }
+}
+
+int RenderThreadPool :: getNumThreads() {
+    return (int)workers.size();
+}
+
+void RenderThreadPool :: stopThreads() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for(std::thread& worker : workers) {
+        if(worker.joinable()) worker.join();
+    }
+    workers.clear();
+}
+
+void RenderThreadPool :: run(int count, const std::function<void(int)>& task) {
+
+    if(count<=0) return;
+
+    // nothing to gain from waking the threads for a single task
+    if(workers.empty() || (count==1)) {
+        for(int i = 0; i<count; i++) task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = task;
+        taskCount = count;
+        nextTaskIndex = 0;
+        busyWorkers = (int)workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    // the calling thread pulls tasks too
+    int index;
+    while((index = nextTaskIndex++) < count) {
+        task(index);
+    }
+
+    // wait for the workers to finish their last tasks
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]{ return busyWorkers==0; });
+    currentTask = nullptr;
+
+}
+
+void RenderThreadPool :: workerFunction(uint64_t startgeneration) {
+
+    uint64_t lastGeneration = startgeneration;
+
+    while(true) {
+
+        int count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [&]{ return stopping || (generation!=lastGeneration); });
+            if(stopping) return;
+            lastGeneration = generation;
+            count = taskCount;
+        }
+
+        int index;
+        while((index = nextTaskIndex++) < count) {
+            currentTask(index);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+            if(busyWorkers==0) doneCondition.notify_all();
+        }
+    }
+}
@@ -0,0 +1,50 @@
+//
+//  ofxLaserRenderThreadPool.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+
+namespace ofxLaser {
+
+// A small pool of worker threads that the ManagerBase uses to render
+// each laser's frame at the same time. The threads are created once and
+// sleep between frames, so there is no thread creation cost per frame.
+class RenderThreadPool {
+
+    public :
+
+    RenderThreadPool();
+    ~RenderThreadPool();
+
+    // calls task(i) for every i from 0 to count-1, spread across the
+    // worker threads (and the calling thread). Blocks until they are all done.
+    void run(int count, const std::function<void(int)>& task);
+
+    // 0 means one less than the number of cores (the calling thread
+    // also does work)
+    void setNumThreads(int numthreads = 0);
+    int getNumThreads();
+
+    protected :
+
+    // startgeneration is the generation when the thread was made
+    void workerFunction(uint64_t startgeneration);
+    void stopThreads();
+
+    vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+
+    std::function<void(int)> currentTask;
+    std::atomic<int> nextTaskIndex;
+    int taskCount = 0;
+    int busyWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+};
+}
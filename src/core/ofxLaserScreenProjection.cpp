@@ -0,0 +1,67 @@
+//
+//  ofxLaserScreenProjection.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserScreenProjection.h"
+
+using namespace ofxLaser;
+
+void ScreenProjection :: update() {
+
+    // no renderer, or one that doesn't draw anything (eg the ofNoopRenderer
+    // with ofAppNoWindow has a 0x0 viewport), so there's nothing to project
+    // onto and the points are used as they are
+    ofRectangle viewport;
+    if(ofGetCurrentRenderer()!=nullptr) viewport = ofGetCurrentViewport();
+    if((viewport.width==0) || (viewport.height==0)) {
+        matrix = glm::mat4(1.0f);
+        identity = true;
+        return;
+    }
+    set(ofGetCurrentMatrix(OF_MATRIX_MODELVIEW), ofGetCurrentMatrix(OF_MATRIX_PROJECTION), viewport, ofGetCurrentOrientationMatrix());
+
+}
+
+void ScreenProjection :: set(const glm::mat4& modelview, const glm::mat4& projection, const ofRectangle& viewport, const glm::mat4& orientation) {
+
+    // the projection matrix includes the screen orientation so take it
+    // back out
+    glm::mat4 clip = glm::inverse(orientation) * projection * modelview;
+
+    // and then from -1 to 1 into the viewport. This is done before the
+    // divide by w, which works because it's just a scale and an offset.
+    glm::mat4 toviewport(1.0f);
+    toviewport[0][0] = viewport.width*0.5f;
+    toviewport[1][1] = viewport.height*0.5f;
+    toviewport[3][0] = (viewport.width*0.5f) + viewport.x;
+    toviewport[3][1] = (viewport.height*0.5f) + viewport.y;
+
+    matrix = toviewport * clip;
+    identity = (matrix == glm::mat4(1.0f));
+
+}
+
+void ScreenProjection :: project(glm::vec3* vertices, size_t count) const {
+
+    if(identity) {
+        for(size_t i = 0; i<count; i++) vertices[i].z = 0;
+        return;
+    }
+
+    // only x, y and w are needed
+    const float m00 = matrix[0][0], m10 = matrix[1][0], m20 = matrix[2][0], m30 = matrix[3][0];
+    const float m01 = matrix[0][1], m11 = matrix[1][1], m21 = matrix[2][1], m31 = matrix[3][1];
+    const float m03 = matrix[0][3], m13 = matrix[1][3], m23 = matrix[2][3], m33 = matrix[3][3];
+
+    for(size_t i = 0; i<count; i++) {
+        glm::vec3& v = vertices[i];
+        float x = (m00*v.x) + (m10*v.y) + (m20*v.z) + m30;
+        float y = (m01*v.x) + (m11*v.y) + (m21*v.z) + m31;
+        float w = (m03*v.x) + (m13*v.y) + (m23*v.z) + m33;
+        v.x = x/w;
+        v.y = y/w;
+        v.z = 0;
+    }
+}
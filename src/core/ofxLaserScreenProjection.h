@@ -0,0 +1,51 @@
+//
+//  ofxLaserScreenProjection.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+
+namespace ofxLaser {
+
+// Converts points from the current openFrameworks coordinate system (with
+// all the ofTranslate / ofRotate / camera transforms) into screen space.
+//
+// The matrices come from the renderer's own copy of the matrix stack
+// rather than from glGetFloatv, and they're combined with the viewport
+// into a single matrix. Call update() once before projecting a batch of
+// points, then each point is just a matrix multiply and a divide.
+//
+// If there's no renderer, or its viewport is empty (for example in a
+// headless app with ofAppNoWindow) the points are left as they are.
+class ScreenProjection {
+
+    public :
+
+    // gets the current matrices and viewport from the renderer
+    void update();
+    // or set them directly
+    void set(const glm::mat4& modelview, const glm::mat4& projection, const ofRectangle& viewport, const glm::mat4& orientation = glm::mat4(1.0f));
+
+    inline glm::vec3 project(const glm::vec3& v) const {
+        if(identity) return glm::vec3(v.x, v.y, 0);
+        glm::vec4 screen = matrix * glm::vec4(v.x, v.y, v.z, 1.0f);
+        return glm::vec3(screen.x/screen.w, screen.y/screen.w, 0);
+    }
+
+    // projects the vertices in place
+    void project(glm::vec3* vertices, size_t count) const;
+    void project(vector<glm::vec3>& vertices) const {
+        if(!vertices.empty()) project(vertices.data(), vertices.size());
+    }
+
+    const glm::mat4& getMatrix() const { return matrix; };
+
+    protected :
+
+    glm::mat4 matrix = glm::mat4(1.0f);
+    bool identity = true;
+
+};
+}
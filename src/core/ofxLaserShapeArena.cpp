@@ -0,0 +1,40 @@
+//
+//  ofxLaserShapeArena.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserShapeArena.h"
+
+using namespace ofxLaser;
+
+void ShapeArena :: reset() {
+    polylines.reset();
+    lines.reset();
+    dots.reset();
+    circles.reset();
+    manualShapes.reset();
+    lastNewShapeCount = newShapeCount;
+    newShapeCount = 0;
+}
+
+void ShapeArena :: clear() {
+    polylines.clear();
+    lines.clear();
+    dots.clear();
+    circles.clear();
+    manualShapes.clear();
+    newShapeCount = lastNewShapeCount = 0;
+}
+
+int ShapeArena :: getNumShapesUsed() const {
+    return (int)(polylines.numUsed + lines.numUsed + dots.numUsed + circles.numUsed + manualShapes.numUsed);
+}
+
+int ShapeArena :: getNumShapesAllocated() const {
+    return (int)(polylines.shapes.size() + lines.shapes.size() + dots.shapes.size() + circles.shapes.size() + manualShapes.shapes.size());
+}
+
+size_t ShapeArena :: getMemoryUsed() const {
+    return polylines.getMemoryUsed() + lines.getMemoryUsed() + dots.getMemoryUsed() + circles.getMemoryUsed() + manualShapes.getMemoryUsed();
+}
@@ -0,0 +1,82 @@
+//
+//  ofxLaserShapeArena.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLaserLine.h"
+#include "ofxLaserDot.h"
+#include "ofxLaserCircle.h"
+#include "ofxLaserPolyline.h"
+#include "ofxLaserManualShape.h"
+
+namespace ofxLaser {
+
+// Stores the shapes made by the manager's draw functions. Rather than
+// creating and deleting every shape each frame, the shapes are kept and
+// reused the next frame, so once there are enough of them there are no
+// more allocations. The Polylines and Circles also keep their vertex
+// storage between frames.
+//
+// Shapes are stored in deques so they don't move when more are added.
+class ShapeArena {
+
+    public :
+
+    // get an unused shape, call init on it before using it. The shapes
+    // are only valid until the next reset.
+    Polyline* getPolyline() { return polylines.get(newShapeCount); };
+    Line* getLine() { return lines.get(newShapeCount); };
+    Dot* getDot() { return dots.get(newShapeCount); };
+    Circle* getCircle() { return circles.get(newShapeCount); };
+    ManualShape* getManualShape() { return manualShapes.get(newShapeCount); };
+
+    // makes all the shapes available again, call once per frame
+    void reset();
+    // deletes all the shapes and frees the memory
+    void clear();
+
+    // the number of shapes used since the last reset
+    int getNumShapesUsed() const;
+    // the number of shapes stored, used or not
+    int getNumShapesAllocated() const;
+    // the number of shapes that had to be created since the last reset,
+    // should be 0 most frames
+    int getNumNewShapes() const { return newShapeCount; };
+    // the shapes created in the previous frame
+    int getNumNewShapesLastFrame() const { return lastNewShapeCount; };
+    // approximate, doesn't include the vertices or colours
+    size_t getMemoryUsed() const;
+
+    protected :
+
+    template<typename T>
+    struct Pool {
+        std::deque<T> shapes;
+        size_t numUsed = 0;
+
+        T* get(int& newcount) {
+            if(numUsed==shapes.size()) {
+                shapes.emplace_back();
+                newcount++;
+            }
+            return &shapes[numUsed++];
+        }
+        void reset() { numUsed = 0; };
+        void clear() { shapes.clear(); numUsed = 0; };
+        size_t getMemoryUsed() const { return shapes.size()*sizeof(T); };
+    };
+
+    Pool<Polyline> polylines;
+    Pool<Line> lines;
+    Pool<Dot> dots;
+    Pool<Circle> circles;
+    Pool<ManualShape> manualShapes;
+
+    int newShapeCount = 0;
+    int lastNewShapeCount = 0;
+
+};
+}
@@ -0,0 +1,204 @@
+//
+//  ofxLaserShapeOrderCache.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserShapeOrderCache.h"
+
+using namespace ofxLaser;
+
+static inline uint64_t combineHash(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash<<6) + (hash>>2);
+    return hash;
+}
+
+bool ShapeOrderCache :: getOrder(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes, const glm::vec2& startposition) {
+
+    currentKeys.resize(shapes.size());
+    currentFingerprint = shapes.size();
+    for(size_t i = 0; i<shapes.size(); i++) {
+        currentKeys[i] = getShapeKey(shapes[i]);
+        currentFingerprint = combineHash(currentFingerprint, currentKeys[i]);
+    }
+
+    if(!cacheValid) {
+        missCount++;
+        return false;
+    }
+
+    if((currentFingerprint==cachedFingerprint) && (currentKeys==cachedKeys)) {
+        // exactly the same shapes as last time so use the same order
+        sortedshapes.clear();
+        for(size_t i = 0; i<cachedOrder.size(); i++) {
+            PointsForShape& shape = shapes[cachedOrder[i]];
+            shape.reversed = cachedReversed[i];
+            sortedshapes.push_back(&shape);
+        }
+        hitCount++;
+        return true;
+    }
+
+    if(repairOrder(shapes, sortedshapes, startposition)) {
+        int changes = changesSinceSort;
+        storeOrder(shapes, sortedshapes);
+        // storeOrder thinks it's a new sort
+        changesSinceSort = changes;
+        repairCount++;
+        return true;
+    }
+
+    sortedshapes.clear();
+    missCount++;
+    return false;
+}
+
+void ShapeOrderCache :: storeOrder(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes) {
+
+    if(currentKeys.size()!=shapes.size()) {
+        // getOrder wasn't called with these shapes
+        clear();
+        return;
+    }
+    cachedKeys = currentKeys;
+    cachedFingerprint = currentFingerprint;
+    cachedOrder.clear();
+    cachedReversed.clear();
+    for(PointsForShape* shape : sortedshapes) {
+        cachedOrder.push_back((int)(shape - shapes.data()));
+        cachedReversed.push_back(shape->reversed);
+    }
+    cacheValid = true;
+    changesSinceSort = 0;
+}
+
+void ShapeOrderCache :: clear() {
+    cacheValid = false;
+    cachedKeys.clear();
+    cachedOrder.clear();
+    cachedReversed.clear();
+    changesSinceSort = 0;
+}
+
+uint64_t ShapeOrderCache :: getShapeKey(PointsForShape& shape) {
+
+    if(shape.size()==0) return 0;
+
+    // positions are rounded to 1/100th of a pixel so that tiny floating
+    // point differences don't count as a change
+    Point& start = shape.front();
+    Point& end = shape.back();
+    uint64_t key = shape.reversable ? 1 : 2;
+    key = combineHash(key, (uint32_t)(int32_t)round(start.x*100));
+    key = combineHash(key, (uint32_t)(int32_t)round(start.y*100));
+    key = combineHash(key, (uint32_t)(int32_t)round(end.x*100));
+    key = combineHash(key, (uint32_t)(int32_t)round(end.y*100));
+    return key;
+}
+
+bool ShapeOrderCache :: repairOrder(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes, const glm::vec2& startposition) {
+
+    int numShapes = (int)shapes.size();
+    if((numShapes==0) || cachedOrder.empty()) return false;
+
+    int maxChanged = MAX(1, (int)(maxChangedProportion * MAX(numShapes, (int)cachedOrder.size())));
+
+    buildKeyLookup(numShapes);
+    shapeUsed.assign(numShapes, 0);
+    sortedshapes.clear();
+
+    // keep all the shapes that are still here in their old order
+    int changedCount = changesSinceSort;
+    for(size_t i = 0; i<cachedOrder.size(); i++) {
+        int shapeindex = findAndRemoveKey(cachedKeys[cachedOrder[i]]);
+        if(shapeindex<0) {
+            // this shape has gone
+            if(++changedCount>maxChanged) return false;
+            continue;
+        }
+
+        PointsForShape& shape = shapes[shapeindex];
+        shape.reversed = cachedReversed[i];
+        shapeUsed[shapeindex] = true;
+        sortedshapes.push_back(&shape);
+    }
+
+    changedCount += numShapes - (int)sortedshapes.size();
+    if(changedCount>maxChanged) return false;
+    changesSinceSort = changedCount;
+
+    // and insert the new ones where they add the least distance
+    glm::vec3 start(startposition.x, startposition.y, 0);
+    for(int i = 0; i<numShapes; i++) {
+        if(shapeUsed[i]) continue;
+        PointsForShape& shape = shapes[i];
+
+        shape.reversed = false;
+        glm::vec3 shapeStart = shape.getStartGlm();
+        glm::vec3 shapeEnd = shape.getEndGlm();
+
+        float bestCost = INFINITY;
+        size_t bestIndex = 0;
+        bool bestReversed = false;
+        for(size_t j = 0; j<=sortedshapes.size(); j++) {
+            glm::vec3 before = (j==0) ? start : sortedshapes[j-1]->getEndGlm();
+            float cost = glm::distance(before, shapeStart);
+            float reversedCost = glm::distance(before, shapeEnd);
+            if(j<sortedshapes.size()) {
+                glm::vec3 after = sortedshapes[j]->getStartGlm();
+                float existing = glm::distance(before, after);
+                cost += glm::distance(shapeEnd, after) - existing;
+                reversedCost += glm::distance(shapeStart, after) - existing;
+            }
+            if(cost<bestCost) {
+                bestCost = cost;
+                bestIndex = j;
+                bestReversed = false;
+            }
+            if(shape.reversable && (reversedCost<bestCost)) {
+                bestCost = reversedCost;
+                bestIndex = j;
+                bestReversed = true;
+            }
+        }
+        shape.reversed = bestReversed;
+        sortedshapes.insert(sortedshapes.begin()+bestIndex, &shape);
+    }
+    return true;
+}
+
+void ShapeOrderCache :: buildKeyLookup(int numShapes) {
+
+    // at least twice as many slots as shapes so the probes stay short
+    size_t size = 16;
+    while(size<(size_t)numShapes*2) size*=2;
+    if(lookupKeys.size()<size) {
+        lookupKeys.resize(size);
+        lookupIndices.resize(size);
+    }
+    lookupMask = size-1;
+    std::fill(lookupIndices.begin(), lookupIndices.begin()+size, -1);
+
+    for(int i = 0; i<numShapes; i++) {
+        size_t slot = currentKeys[i] & lookupMask;
+        while(lookupIndices[slot]!=-1) slot = (slot+1) & lookupMask;
+        lookupKeys[slot] = currentKeys[i];
+        lookupIndices[slot] = i;
+    }
+}
+
+int ShapeOrderCache :: findAndRemoveKey(uint64_t key) {
+
+    // shapes can have the same key so we carry on past any that have
+    // already been used
+    size_t slot = key & lookupMask;
+    while(lookupIndices[slot]!=-1) {
+        if((lookupIndices[slot]>=0) && (lookupKeys[slot]==key)) {
+            int shapeindex = lookupIndices[slot];
+            lookupIndices[slot] = -2;
+            return shapeindex;
+        }
+        slot = (slot+1) & lookupMask;
+    }
+    return -1;
+}
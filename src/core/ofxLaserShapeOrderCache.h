@@ -0,0 +1,76 @@
+//
+//  ofxLaserShapeOrderCache.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLaserPointsForShape.h"
+
+namespace ofxLaser {
+
+// Remembers the order that the shapes were drawn in last frame so that if
+// the next frame has the same shapes (most of the time only the colours
+// change, if anything) we don't need to sort them again.
+//
+// Each shape is identified by its start and end points and whether it can be
+// reversed. If only a few shapes have been added or removed, the old order is
+// kept and the new shapes are slotted in wherever they add the least
+// distance. The repairs build on each other so once enough shapes have
+// changed since the last proper sort, we sort again anyway.
+class ShapeOrderCache {
+
+    public :
+
+    // if the shapes match the last frame, fills sortedshapes and sets the
+    // reversed flags and returns true. Otherwise returns false and the
+    // shapes need sorting (and then pass the result into storeOrder).
+    bool getOrder(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes, const glm::vec2& startposition);
+
+    // call this after sorting the shapes passed to the last getOrder call
+    void storeOrder(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes);
+
+    void clear();
+
+    // the maximum proportion of shapes that can change (in one frame or
+    // added up over all the repairs since the last sort) before we give up
+    // and sort again
+    float maxChangedProportion = 0.1f;
+
+    int hitCount = 0;
+    int repairCount = 0;
+    int missCount = 0;
+
+    protected :
+
+    uint64_t getShapeKey(PointsForShape& shape);
+    bool repairOrder(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes, const glm::vec2& startposition);
+
+    // the keys for the shapes passed in to the last getOrder call
+    vector<uint64_t> currentKeys;
+    uint64_t currentFingerprint = 0;
+
+    // the shape keys and order from the last sort
+    vector<uint64_t> cachedKeys;
+    uint64_t cachedFingerprint = 0;
+    vector<int> cachedOrder;
+    vector<char> cachedReversed;
+    bool cacheValid = false;
+    // how many shapes have been added or removed by repairs since the
+    // order was last sorted properly
+    int changesSinceSort = 0;
+
+    // temp storage used when repairing the order. The lookup is a hash
+    // table of shape indices (open addressing, -1 is empty and -2 is a
+    // shape that's been used), it only grows so it doesn't allocate once
+    // it's big enough
+    void buildKeyLookup(int numShapes);
+    int findAndRemoveKey(uint64_t key);
+    vector<uint64_t> lookupKeys;
+    vector<int> lookupIndices;
+    size_t lookupMask = 0;
+    vector<char> shapeUsed;
+
+};
+}
@@ -0,0 +1,330 @@
+//
+//  ofxLaserShapeSorter.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserShapeSorter.h"
+
+using namespace ofxLaser;
+
+void ShapeSorter :: sortShapes(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes, const glm::vec2& startposition) {
+
+    sortedshapes.clear();
+    order.clear();
+    reversedInPath.clear();
+    lastMoveDistance = 0;
+    pathStartPosition = startposition;
+
+    // store the start and end positions for each shape, we don't want to be
+    // going back into the point vectors every time we check a distance
+    sourceIndices.clear();
+    shapeStarts.clear();
+    shapeEnds.clear();
+    shapeReversable.clear();
+    for(size_t i = 0; i<shapes.size(); i++) {
+        PointsForShape& shape = shapes[i];
+        if(shape.size()==0) continue;
+        sourceIndices.push_back((int)i);
+        shapeStarts.push_back(glm::vec2(shape.front().x, shape.front().y));
+        shapeEnds.push_back(glm::vec2(shape.back().x, shape.back().y));
+        shapeReversable.push_back(shape.reversable);
+    }
+
+    int numShapes = (int)sourceIndices.size();
+    if(numShapes==0) return;
+
+    buildGrid();
+
+    // nearest neighbour sort, same as the original method but it only
+    // has to search the grid cells around the current position
+    glm::vec2 position = startposition;
+    for(int i = 0; i<numShapes; i++) {
+        bool reversed = false;
+        int shapeindex = findNearestShape(position, reversed);
+        if(shapeindex<0) break;
+
+        removeFromGrid(shapeindex*2);
+        removeFromGrid(shapeindex*2+1);
+
+        order.push_back(shapeindex);
+        reversedInPath.push_back(reversed);
+        position = reversed ? shapeStarts[shapeindex] : shapeEnds[shapeindex];
+    }
+
+    optimise();
+
+    for(size_t i = 0; i<order.size(); i++) {
+        PointsForShape& shape = shapes[sourceIndices[order[i]]];
+        shape.reversed = reversedInPath[i];
+        sortedshapes.push_back(&shape);
+        lastMoveDistance += glm::distance(getEndBefore((int)i), getPathStart((int)i));
+    }
+}
+
+void ShapeSorter :: buildGrid() {
+
+    int numShapes = (int)shapeStarts.size();
+
+    // get the bounds of all the end points
+    glm::vec2 topleft = shapeStarts[0];
+    glm::vec2 bottomright = shapeStarts[0];
+    int numEndpoints = 0;
+    for(int i = 0; i<numShapes; i++) {
+        topleft = glm::min(topleft, shapeStarts[i]);
+        bottomright = glm::max(bottomright, shapeStarts[i]);
+        numEndpoints++;
+        if(shapeReversable[i]) {
+            topleft = glm::min(topleft, shapeEnds[i]);
+            bottomright = glm::max(bottomright, shapeEnds[i]);
+            numEndpoints++;
+        }
+    }
+
+    // aim for about two end points per cell
+    int gridSize = ofClamp(round(sqrt(numEndpoints/2.0f)), 1, 256);
+    gridColumns = gridRows = gridSize;
+    gridOrigin = topleft;
+    cellWidth = MAX(bottomright.x - topleft.x, 0.001f)/gridColumns;
+    cellHeight = MAX(bottomright.y - topleft.y, 0.001f)/gridRows;
+
+    int numCells = gridColumns*gridRows;
+    cellStarts.assign(numCells, 0);
+    cellCounts.assign(numCells, 0);
+    endpointCells.assign(numShapes*2, -1);
+    endpointSlots.assign(numShapes*2, -1);
+    cellEntries.resize(numEndpoints);
+    liveEndpointCount = numEndpoints;
+
+    // count the end points in each cell
+    for(int e = 0; e<numShapes*2; e++) {
+        int shapeindex = e/2;
+        bool isEnd = (e%2)==1;
+        if(isEnd && !shapeReversable[shapeindex]) continue;
+        const glm::vec2& p = isEnd ? shapeEnds[shapeindex] : shapeStarts[shapeindex];
+        int column = ofClamp((int)((p.x-gridOrigin.x)/cellWidth), 0, gridColumns-1);
+        int row = ofClamp((int)((p.y-gridOrigin.y)/cellHeight), 0, gridRows-1);
+        int cell = column + (row*gridColumns);
+        endpointCells[e] = cell;
+        cellCounts[cell]++;
+    }
+
+    // then figure out where each cell starts and fill them in
+    int total = 0;
+    for(int c = 0; c<numCells; c++) {
+        cellStarts[c] = total;
+        total+=cellCounts[c];
+        cellCounts[c] = 0;
+    }
+    for(int e = 0; e<numShapes*2; e++) {
+        int cell = endpointCells[e];
+        if(cell<0) continue;
+        int slot = cellStarts[cell] + cellCounts[cell];
+        cellEntries[slot] = e;
+        endpointSlots[e] = slot;
+        cellCounts[cell]++;
+    }
+}
+
+void ShapeSorter :: removeFromGrid(int endpointindex) {
+
+    int cell = endpointCells[endpointindex];
+    if(cell<0) return;
+
+    // swap it with the last live entry in the cell
+    int lastslot = cellStarts[cell] + cellCounts[cell] - 1;
+    int slot = endpointSlots[endpointindex];
+    int otherindex = cellEntries[lastslot];
+
+    cellEntries[slot] = otherindex;
+    endpointSlots[otherindex] = slot;
+    cellEntries[lastslot] = endpointindex;
+    endpointSlots[endpointindex] = lastslot;
+
+    cellCounts[cell]--;
+    endpointCells[endpointindex] = -1;
+    liveEndpointCount--;
+}
+
+int ShapeSorter :: findNearestShape(const glm::vec2& position, bool& reversed) {
+
+    if(liveEndpointCount<=0) return -1;
+
+    int column = ofClamp((int)floor((position.x-gridOrigin.x)/cellWidth), 0, gridColumns-1);
+    int row = ofClamp((int)floor((position.y-gridOrigin.y)/cellHeight), 0, gridRows-1);
+
+    float minCellSize = MIN(cellWidth, cellHeight);
+    float shortestDistance = INFINITY;
+    int nearest = -1;
+    int maxRing = MAX(gridColumns, gridRows);
+
+    // search outwards in square rings of cells. Anything in ring r is at least
+    // (r-1) cells away, so once we have something closer than that we can stop
+    for(int ring = 0; ring<=maxRing; ring++) {
+
+        if(nearest>=0 && ring>0) {
+            float minDistance = (ring-1)*minCellSize;
+            if(minDistance*minDistance >= shortestDistance) break;
+        }
+
+        for(int y = row-ring; y<=row+ring; y++) {
+            if(y<0 || y>=gridRows) continue;
+            bool edgeRow = (y==row-ring) || (y==row+ring);
+            int step = edgeRow ? 1 : MAX(ring*2, 1);
+
+            for(int x = column-ring; x<=column+ring; x+=step) {
+                if(x<0 || x>=gridColumns) continue;
+                int cell = x + (y*gridColumns);
+                int start = cellStarts[cell];
+                int end = start + cellCounts[cell];
+                for(int slot = start; slot<end; slot++) {
+                    int e = cellEntries[slot];
+                    int shapeindex = e/2;
+                    bool isEnd = (e%2)==1;
+                    const glm::vec2& p = isEnd ? shapeEnds[shapeindex] : shapeStarts[shapeindex];
+                    glm::vec2 diff = p - position;
+                    float distance = glm::dot(diff, diff);
+                    // prefer unreversed shapes when they're equal
+                    if((distance<shortestDistance) || ((distance==shortestDistance) && reversed && !isEnd)) {
+                        shortestDistance = distance;
+                        nearest = shapeindex;
+                        reversed = isEnd;
+                    }
+                }
+            }
+        }
+    }
+    return nearest;
+}
+
+void ShapeSorter :: optimise() {
+
+    for(int pass = 0; pass<maxOptimisationPasses; pass++) {
+        bool improved = improveTwoOpt();
+        improved = improveOrOpt() || improved;
+        if(!improved) break;
+    }
+}
+
+// reverses runs of shapes (and the direction of each shape in the run) if it
+// makes the moves at either end of the run shorter. The moves inside the run
+// stay the same length, so we only have to check the two ends.
+bool ShapeSorter :: improveTwoOpt() {
+
+    bool improved = false;
+    int numShapes = (int)order.size();
+
+    for(int i = 0; i<numShapes; i++) {
+
+        glm::vec2 before = getEndBefore(i);
+        int lastj = MIN(numShapes-1, i+optimisationWindow);
+
+        for(int j = i; j<=lastj; j++) {
+
+            // can't reverse a run that has a shape that can't be reversed
+            if(!shapeReversable[order[j]]) break;
+
+            bool hasNext = j<numShapes-1;
+            float currentDistance = glm::distance(before, getPathStart(i));
+            float newDistance = glm::distance(before, getPathEnd(j));
+            if(hasNext) {
+                const glm::vec2& next = getPathStart(j+1);
+                currentDistance += glm::distance(getPathEnd(j), next);
+                newDistance += glm::distance(getPathStart(i), next);
+            }
+
+            if(newDistance < currentDistance - 0.001f) {
+                std::reverse(order.begin()+i, order.begin()+j+1);
+                std::reverse(reversedInPath.begin()+i, reversedInPath.begin()+j+1);
+                for(int k = i; k<=j; k++) reversedInPath[k] = !reversedInPath[k];
+                improved = true;
+            }
+        }
+    }
+    return improved;
+}
+
+// takes runs of one to three shapes and sees if they're better off
+// somewhere else in the path, either way round.
+bool ShapeSorter :: improveOrOpt() {
+
+    bool improved = false;
+    int numShapes = (int)order.size();
+
+    for(int runLength = 1; runLength<=3; runLength++) {
+        for(int i = 0; i+runLength<=numShapes; i++) {
+
+            int last = i+runLength-1;
+            bool canReverse = true;
+            for(int k = i; k<=last; k++) canReverse &= (shapeReversable[order[k]]!=0);
+
+            glm::vec2 runStart = getPathStart(i);
+            glm::vec2 runEnd = getPathEnd(last);
+            glm::vec2 before = getEndBefore(i);
+            bool hasNext = last<numShapes-1;
+
+            // how much we save by taking the run out
+            float saving = glm::distance(before, runStart);
+            if(hasNext) {
+                const glm::vec2& next = getPathStart(last+1);
+                saving += glm::distance(runEnd, next) - glm::distance(before, next);
+            }
+            if(saving<=0.001f) continue;
+
+            // find the cheapest place to put it back in, target is the
+            // index that it would be inserted before
+            int bestTarget = -1;
+            bool bestReversed = false;
+            float bestCost = saving - 0.001f;
+
+            int firsttarget = MAX(0, i-optimisationWindow);
+            int lasttarget = MIN(numShapes, last+1+optimisationWindow);
+            for(int target = firsttarget; target<=lasttarget; target++) {
+                // inserting next to where it already is doesn't change anything
+                if((target>=i) && (target<=last+1)) continue;
+
+                const glm::vec2& x = getEndBefore(target);
+                bool hasY = target<numShapes;
+                float cost = glm::distance(x, runStart);
+                float reversedCost = glm::distance(x, runEnd);
+                if(hasY) {
+                    const glm::vec2& y = getPathStart(target);
+                    float existing = glm::distance(x, y);
+                    cost += glm::distance(runEnd, y) - existing;
+                    reversedCost += glm::distance(runStart, y) - existing;
+                }
+                if(cost<bestCost) {
+                    bestCost = cost;
+                    bestTarget = target;
+                    bestReversed = false;
+                }
+                if(canReverse && (reversedCost<bestCost)) {
+                    bestCost = reversedCost;
+                    bestTarget = target;
+                    bestReversed = true;
+                }
+            }
+
+            if(bestTarget<0) continue;
+
+            // move the run into place
+            int newstart;
+            if(bestTarget<i) {
+                std::rotate(order.begin()+bestTarget, order.begin()+i, order.begin()+last+1);
+                std::rotate(reversedInPath.begin()+bestTarget, reversedInPath.begin()+i, reversedInPath.begin()+last+1);
+                newstart = bestTarget;
+            } else {
+                std::rotate(order.begin()+i, order.begin()+last+1, order.begin()+bestTarget);
+                std::rotate(reversedInPath.begin()+i, reversedInPath.begin()+last+1, reversedInPath.begin()+bestTarget);
+                newstart = bestTarget-runLength;
+            }
+            if(bestReversed) {
+                std::reverse(order.begin()+newstart, order.begin()+newstart+runLength);
+                std::reverse(reversedInPath.begin()+newstart, reversedInPath.begin()+newstart+runLength);
+                for(int k = newstart; k<newstart+runLength; k++) reversedInPath[k] = !reversedInPath[k];
+            }
+            improved = true;
+        }
+    }
+    return improved;
+}
@@ -0,0 +1,90 @@
+//
+//  ofxLaserShapeSorter.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLaserPointsForShape.h"
+
+namespace ofxLaser {
+
+// Sorts the shapes for a laser frame to minimise the distance the laser has
+// to travel between them. Works like the nearest neighbour sort in
+// Laser::send, but the shape end points are stored in a grid so each
+// search only checks the cells nearby rather than every shape. The
+// resulting path is then improved with a few passes of 2-opt (reversing
+// runs of shapes) and Or-opt (moving a run of up to three shapes somewhere
+// else in the path).
+//
+// All the buffers are kept between frames so there are no allocations once
+// they have grown large enough.
+class ShapeSorter {
+
+    public :
+
+    // fills sortedshapes with pointers to the shapes in the order they should
+    // be drawn, and sets the reversed flag for each shape.
+    void sortShapes(vector<PointsForShape>& shapes, vector<PointsForShape*>& sortedshapes, const glm::vec2& startposition);
+
+    // the maximum number of improvement passes over the whole path
+    int maxOptimisationPasses = 2;
+    // how far along the path (in shapes) we look for improvements
+    int optimisationWindow = 12;
+
+    // the total distance between shapes for the last sort, including
+    // the move from the start position
+    float lastMoveDistance = 0;
+
+    protected :
+
+    void buildGrid();
+    void removeFromGrid(int endpointindex);
+    int findNearestShape(const glm::vec2& position, bool& reversed);
+    void optimise();
+
+    bool improveTwoOpt();
+    bool improveOrOpt();
+
+    // the start and end of the shape at position i in the path
+    // taking into account whether it's reversed
+    inline const glm::vec2& getPathStart(int i) {
+        return reversedInPath[i] ? shapeEnds[order[i]] : shapeStarts[order[i]];
+    }
+    inline const glm::vec2& getPathEnd(int i) {
+        return reversedInPath[i] ? shapeStarts[order[i]] : shapeEnds[order[i]];
+    }
+    // the end of the shape before position i, or the start position
+    inline const glm::vec2& getEndBefore(int i) {
+        return (i==0) ? pathStartPosition : getPathEnd(i-1);
+    }
+
+    glm::vec2 pathStartPosition;
+
+    // per shape (only the shapes that have points)
+    vector<int> sourceIndices;
+    vector<glm::vec2> shapeStarts;
+    vector<glm::vec2> shapeEnds;
+    vector<char> shapeReversable;
+
+    // the path, by position
+    vector<int> order;
+    vector<char> reversedInPath;
+
+    // grid of end points. End point 2n is the start of shape n and
+    // 2n+1 is the end.
+    int gridColumns = 1;
+    int gridRows = 1;
+    float cellWidth = 1;
+    float cellHeight = 1;
+    glm::vec2 gridOrigin;
+    vector<int> cellStarts;
+    vector<int> cellCounts;
+    vector<int> cellEntries;
+    vector<int> endpointCells;
+    vector<int> endpointSlots;
+    int liveEndpointCount = 0;
+
+};
+}
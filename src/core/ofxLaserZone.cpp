@@ -84,7 +84,9 @@ ofPoint& Zone::addSortedShapesToVector(vector<ofxLaser::Shape*>& shapesContainer
 		ofFloatColor c = ofColor(255);
 		
 		// add a dummy shape to fix the start position
-		shapes.push_front(new ofxLaser::Dot(currentPosition, c, 1, ""));
+		// (reused each time rather than made every frame)
+		startDot.init(currentPosition, c, 1, "");
+		shapes.push_front(&startDot);
 		
 		for(size_t i=0; i<shapes.size(); i++ ) {
 			shapes[i]->tested = false;
@@ -141,8 +143,6 @@ ofPoint& Zone::addSortedShapesToVector(vector<ofxLaser::Shape*>& shapesContainer
 			
 		} while (currentIndex>-1);
 		
-		// TODO - delete the dummy shape at the start?
-		delete sortedShapes[0];
 		sortedShapes.pop_front();
 		shapes.pop_front();
 		
@@ -40,6 +40,8 @@ namespace ofxLaser {
 	
         protected : 
 		int index = 0;
+		// the dummy shape used to fix the start position when sorting
+		Dot startDot;
 		
 		
 	};
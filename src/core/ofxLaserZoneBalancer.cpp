@@ -0,0 +1,170 @@
+//
+//  ofxLaserZoneBalancer.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserZoneBalancer.h"
+
+using namespace ofxLaser;
+
+void ZoneBalancer :: setZones(const vector<ofRectangle>& zonerects, const vector<vector<int>>& zonelasers) {
+
+    zoneRects = zonerects;
+    zoneLasers = zonelasers;
+    zoneLasers.resize(zoneRects.size());
+
+    ofRectangle bounds;
+    for(size_t i = 0; i<zoneRects.size(); i++) {
+        if(i==0) bounds = zoneRects[i];
+        else bounds.growToInclude(zoneRects[i]);
+    }
+    zoneGrid.update(zoneRects, bounds);
+
+}
+
+void ZoneBalancer :: setLaserBudgets(const vector<float>& budgets) {
+
+    laserStates.resize(budgets.size());
+    for(size_t i = 0; i<budgets.size(); i++) {
+        laserStates[i] = LaserState();
+        laserStates[i].budget = budgets[i];
+    }
+
+}
+
+void ZoneBalancer :: assignShapes(const vector<Shape*>& shapes, const PointEstimator& estimator) {
+
+    currentShapes = &shapes;
+    currentEstimator = &estimator;
+    for(LaserState& state : laserStates) {
+        state.used = 0;
+        state.positionTotal = glm::vec2(0,0);
+        state.numShapes = 0;
+    }
+    assignments.clear();
+
+    // find the zones each shape touches and which of those it's inside
+    if(touchingZones.size()<shapes.size()) {
+        touchingZones.resize(shapes.size());
+        enclosingZones.resize(shapes.size());
+    }
+    for(size_t i = 0; i<shapes.size(); i++) {
+        Shape& shape = *shapes[i];
+        const ofRectangle& box = shape.getBoundingBox();
+        touchingZones[i].clear();
+        enclosingZones[i].clear();
+
+        for(int j : zoneGrid.getZonesForRect(box)) {
+            ofRectangle& rect = zoneRects[j];
+            if(!shape.intersectsRect(rect)) continue;
+            touchingZones[i].push_back(j);
+            if((box.getLeft()>=rect.getLeft()) && (box.getRight()<=rect.getRight()) && (box.getTop()>=rect.getTop()) && (box.getBottom()<=rect.getBottom())) {
+                enclosingZones[i].push_back(j);
+            }
+        }
+    }
+
+    // first the shapes that don't have a choice
+    for(size_t i = 0; i<shapes.size(); i++) {
+        if(enclosingZones[i].size()==1) {
+            addShapeToZone((int)i, enclosingZones[i][0]);
+        } else if(enclosingZones[i].empty()) {
+            // crosses the zone edges (or isn't in any zone at all)
+            for(int j : touchingZones[i]) addShapeToZone((int)i, j);
+        }
+    }
+
+    // then the ones that could go in more than one zone
+    for(size_t i = 0; i<shapes.size(); i++) {
+        vector<int>& candidates = enclosingZones[i];
+        if(candidates.size()<2) continue;
+
+        Shape& shape = *shapes[i];
+        const ofRectangle& box = shape.getBoundingBox();
+        glm::vec2 position(box.getCenter().x, box.getCenter().y);
+
+        vector<float>& remaining = candidateRemaining;
+        remaining.resize(candidates.size());
+        float best = -INFINITY;
+        float margin = 0;
+        for(size_t c = 0; c<candidates.size(); c++) {
+            remaining[c] = getRemainingForZone(candidates[c], shape, estimator);
+            best = MAX(best, remaining[c]);
+            for(int laser : zoneLasers[candidates[c]]) {
+                margin = MAX(margin, laserStates[laser].budget*tieMargin);
+            }
+        }
+
+        // of the zones with about the most points left, use the nearest
+        int chosen = -1;
+        float nearest = INFINITY;
+        for(size_t c = 0; c<candidates.size(); c++) {
+            if(remaining[c]<best-margin) continue;
+            float distance = getDistanceForZone(candidates[c], position);
+            if(distance<nearest) {
+                nearest = distance;
+                chosen = candidates[c];
+            }
+        }
+        if(chosen<0) chosen = candidates[0];
+        addShapeToZone((int)i, chosen);
+    }
+
+    // and put them in the zones in the original order
+    std::sort(assignments.begin(), assignments.end());
+    zoneShapes.resize(zoneRects.size());
+    for(vector<Shape*>& zoneshapes : zoneShapes) zoneshapes.clear();
+    for(std::pair<int,int>& assignment : assignments) {
+        zoneShapes[assignment.second].push_back(shapes[assignment.first]);
+    }
+
+    currentShapes = nullptr;
+    currentEstimator = nullptr;
+
+}
+
+void ZoneBalancer :: addShapeToZone(int shapeindex, int zoneindex) {
+
+    assignments.emplace_back(shapeindex, zoneindex);
+
+    Shape& shape = *(*currentShapes)[shapeindex];
+    const ofRectangle& box = shape.getBoundingBox();
+    for(int laser : zoneLasers[zoneindex]) {
+        LaserState& state = laserStates[laser];
+        state.used += (*currentEstimator)(shape, laser);
+        state.positionTotal += glm::vec2(box.getCenter().x, box.getCenter().y);
+        state.numShapes++;
+    }
+
+}
+
+float ZoneBalancer :: getRemainingForZone(int zoneindex, Shape& shape, const PointEstimator& estimator) {
+
+    // a zone with no lasers is no use
+    const vector<int>& lasers = zoneLasers[zoneindex];
+    if(lasers.empty()) return -INFINITY;
+
+    // if the zone is on more than one laser, it's the one with the least left
+    float remaining = INFINITY;
+    for(int laser : lasers) {
+        LaserState& state = laserStates[laser];
+        remaining = MIN(remaining, state.budget - state.used - estimator(shape, laser));
+    }
+    return remaining;
+
+}
+
+float ZoneBalancer :: getDistanceForZone(int zoneindex, const glm::vec2& position) {
+
+    // the distance to the middle of the shapes that the lasers are drawing.
+    // If a laser isn't drawing anything yet then it's as near as can be.
+    float distance = INFINITY;
+    for(int laser : zoneLasers[zoneindex]) {
+        LaserState& state = laserStates[laser];
+        if(state.numShapes==0) return 0;
+        distance = MIN(distance, glm::distance(position, state.positionTotal/(float)state.numShapes));
+    }
+    return distance;
+
+}
@@ -0,0 +1,83 @@
+//
+//  ofxLaserZoneBalancer.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLaserShape.h"
+#include "ofxLaserZoneGrid.h"
+
+namespace ofxLaser {
+
+// Decides which zones the shapes go in for OFXLASER_ZONE_OPTIMISE.
+//
+// If a shape is entirely inside more than one zone, it only needs drawing
+// by one of them, so it goes in the zone whose lasers have the most points
+// left in their frame (pps / target framerate). If a few zones have about
+// the same left, it goes in the one nearest to the other shapes that its
+// lasers are drawing. Shapes that cross the edge of a zone go in every zone
+// they touch, the same as OFXLASER_ZONE_AUTOMATIC.
+//
+// The shapes that can only go in one place are assigned first, so that
+// the rest can fill in around them.
+class ZoneBalancer {
+
+    public :
+
+    // returns the number of points that the laser will need for the shape
+    typedef std::function<float(Shape& shape, int laserindex)> PointEstimator;
+
+    // call before assignShapes. zonelasers has the indices of the lasers that
+    // draw each zone, and budgets has the number of points each laser can
+    // draw in a frame.
+    void setZones(const vector<ofRectangle>& zonerects, const vector<vector<int>>& zonelasers);
+    void setLaserBudgets(const vector<float>& budgets);
+
+    // works out the shapes for each zone, they're in the same order as
+    // the shapes that are passed in.
+    void assignShapes(const vector<Shape*>& shapes, const PointEstimator& estimator);
+    const vector<Shape*>& getShapesForZone(int zoneindex) { return zoneShapes.at(zoneindex); };
+
+    // the estimated points used by each laser after the last assignShapes
+    float getPointsUsed(int laserindex) { return laserStates.at(laserindex).used; };
+    float getBudget(int laserindex) { return laserStates.at(laserindex).budget; };
+    int getNumLasers() { return (int)laserStates.size(); };
+
+    // zones whose lasers have less than this proportion of a frame
+    // between them count as the same, and the nearest one is used
+    float tieMargin = 0.02f;
+
+    protected :
+
+    struct LaserState {
+        float budget = 0;
+        float used = 0;
+        // to work out the middle of the shapes that it's drawing
+        glm::vec2 positionTotal;
+        int numShapes = 0;
+    };
+
+    void addShapeToZone(int shapeindex, int zoneindex);
+    float getRemainingForZone(int zoneindex, Shape& shape, const PointEstimator& estimator);
+    float getDistanceForZone(int zoneindex, const glm::vec2& position);
+
+    vector<ofRectangle> zoneRects;
+    vector<vector<int>> zoneLasers;
+    vector<LaserState> laserStates;
+    ZoneGrid zoneGrid;
+
+    const vector<Shape*>* currentShapes = nullptr;
+    const PointEstimator* currentEstimator = nullptr;
+
+    // the zones that each shape touches and that it fits inside
+    vector<vector<int>> touchingZones;
+    vector<vector<int>> enclosingZones;
+    // the shape index and zone index of each assignment
+    vector<std::pair<int,int>> assignments;
+    vector<float> candidateRemaining;
+    vector<vector<Shape*>> zoneShapes;
+
+};
+}
@@ -0,0 +1,93 @@
+//
+//  ofxLaserZoneGrid.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserZoneGrid.h"
+
+using namespace ofxLaser;
+
+void ZoneGrid :: update(const vector<ofRectangle>& zonerects, const ofRectangle& bounds) {
+
+    if((zonerects==rects) && (bounds==gridBounds) && (numColumns>0)) return;
+
+    rects = zonerects;
+    gridBounds = bounds;
+    rebuild();
+
+}
+
+void ZoneGrid :: rebuild() {
+
+    // about two cells across for each zone across, which is plenty when
+    // the zones are tiled and doesn't use much memory when there are lots
+    int divisions = ofClamp(ceil(sqrt((float)rects.size()))*2, 1, 32);
+    numColumns = numRows = divisions;
+    cellWidth = MAX(gridBounds.width, 1.0f)/numColumns;
+    cellHeight = MAX(gridBounds.height, 1.0f)/numRows;
+
+    // count the zones in each cell and then fill them in
+    int numCells = numColumns*numRows;
+    cellStarts.assign(numCells+1, 0);
+    for(int pass = 0; pass<2; pass++) {
+        vector<int> cellCounts(numCells, 0);
+        for(size_t i = 0; i<rects.size(); i++) {
+            const ofRectangle& rect = rects[i];
+            int left = getColumn(rect.getLeft());
+            int right = getColumn(rect.getRight());
+            int top = getRow(rect.getTop());
+            int bottom = getRow(rect.getBottom());
+            for(int row = top; row<=bottom; row++) {
+                for(int col = left; col<=right; col++) {
+                    int cell = (row*numColumns)+col;
+                    if(pass==0) cellStarts[cell+1]++;
+                    else cellZones[cellStarts[cell]+(cellCounts[cell]++)] = (int)i;
+                }
+            }
+        }
+        if(pass==0) {
+            for(int cell = 0; cell<numCells; cell++) cellStarts[cell+1]+=cellStarts[cell];
+            cellZones.resize(cellStarts[numCells]);
+        }
+    }
+
+    zoneStamps.assign(rects.size(), 0);
+    currentStamp = 0;
+
+}
+
+const vector<int>& ZoneGrid :: getZonesForRect(const ofRectangle& rect) {
+
+    result.clear();
+    if(rects.empty()) return result;
+
+    currentStamp++;
+    if(currentStamp==0) {
+        // wrapped around
+        std::fill(zoneStamps.begin(), zoneStamps.end(), 0);
+        currentStamp = 1;
+    }
+
+    int left = getColumn(rect.getLeft());
+    int right = getColumn(rect.getRight());
+    int top = getRow(rect.getTop());
+    int bottom = getRow(rect.getBottom());
+
+    for(int row = top; row<=bottom; row++) {
+        for(int col = left; col<=right; col++) {
+            int cell = (row*numColumns)+col;
+            for(int i = cellStarts[cell]; i<cellStarts[cell+1]; i++) {
+                int zone = cellZones[i];
+                if(zoneStamps[zone]==currentStamp) continue;
+                zoneStamps[zone] = currentStamp;
+                result.push_back(zone);
+            }
+        }
+    }
+
+    // keep them in zone order, there aren't usually many
+    std::sort(result.begin(), result.end());
+    return result;
+
+}
@@ -0,0 +1,64 @@
+//
+//  ofxLaserZoneGrid.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+
+namespace ofxLaser {
+
+// A grid over the canvas that stores which zones overlap each cell, so
+// that for each shape we only have to test the zones near its bounding
+// box rather than all of them.
+//
+// It only narrows down the zones, it never leaves one out that the shape
+// could be in, so the shapes still need testing against the zones that
+// it returns.
+class ZoneGrid {
+
+    public :
+
+    // call every frame with the zone rectangles, the grid is only rebuilt
+    // if they've changed. Anything outside the bounds goes in the edge cells.
+    void update(const vector<ofRectangle>& zonerects, const ofRectangle& bounds);
+
+    // the indices of the zones that could overlap the rectangle, in order.
+    // Only valid until the next call.
+    const vector<int>& getZonesForRect(const ofRectangle& rect);
+
+    int getNumColumns() { return numColumns; };
+    int getNumRows() { return numRows; };
+
+    protected :
+
+    void rebuild();
+    inline int getColumn(float x) const {
+        int col = (int)floorf((x-gridBounds.x)/cellWidth);
+        return (col<0) ? 0 : (col>=numColumns) ? numColumns-1 : col;
+    }
+    inline int getRow(float y) const {
+        int row = (int)floorf((y-gridBounds.y)/cellHeight);
+        return (row<0) ? 0 : (row>=numRows) ? numRows-1 : row;
+    }
+
+    vector<ofRectangle> rects;
+    ofRectangle gridBounds;
+    int numColumns = 0;
+    int numRows = 0;
+    float cellWidth = 1;
+    float cellHeight = 1;
+
+    // the zone indices for each cell, cellStarts has one more entry than
+    // the number of cells
+    vector<int> cellStarts;
+    vector<int> cellZones;
+
+    // to stop a zone being added more than once
+    vector<unsigned int> zoneStamps;
+    unsigned int currentStamp = 0;
+    vector<int> result;
+
+};
+}
@@ -12,6 +12,10 @@ using namespace ofxLaser;
 
 #ifdef _MSC_VER
 #include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
 #endif
 //
 //int dac_point:: createCount = 0;
@@ -22,9 +26,13 @@ DacEtherdream :: DacEtherdream(){
 	pointBufferDisplay.set("Point Buffer", 0,0,1799);
 	latencyDisplay.set("Latency", 0,0,10000);
 	reconnectCount.set("Reconnect Count", 0, 0,10);
+	targetBufferDisplay.set("Target Buffer", 0,0,1799);
+	outputLatencyDisplay.set("Output Latency", 0,0,100000);
 	displayData.push_back(&pointBufferDisplay);
 	displayData.push_back(&latencyDisplay);
 	displayData.push_back(&reconnectCount);
+	displayData.push_back(&targetBufferDisplay);
+	displayData.push_back(&outputLatencyDisplay);
     numPointsToSend = 0;
     
     
@@ -38,6 +46,9 @@ DacEtherdream :: DacEtherdream(){
 	pointsToSendBeforePlaying = 500;    //500;//100; 	// the minimum number of points to buffer before
 										// we tell the ED to start playing
 										// TODO - these should be time based!
+	maxDataCommandsInFlight = 3;
+	minPointsPerPacket = 100;
+	adaptiveLatency = false;
 
 }
 const vector<ofAbstractParameter*>& DacEtherdream :: getDisplayData() {
@@ -51,6 +62,8 @@ const vector<ofAbstractParameter*>& DacEtherdream :: getDisplayData() {
 																 
 		latencyDisplay += (latencyMicros - latencyDisplay)*0.1;
 		reconnectCount = prepareSendCount;
+		targetBufferDisplay = dacBufferSize;
+		outputLatencyDisplay = getOutputLatencyMicros();
 	
 		unlock();
 	}
@@ -62,32 +75,25 @@ DacEtherdream :: ~DacEtherdream(){
 	
 	close();
 	
-	for (size_t i= 0; i < sparePoints.size(); ++i) {
-		delete sparePoints[i]; // Calls ~object (which deallocates tmp[i]->foo)
-		// and deallocates *tmp[i]
-	}
-	sparePoints.clear();
-	for (size_t i= 0; i < bufferedPoints.size(); ++i) {
-		delete bufferedPoints[i]; // Calls ~object (which deallocates tmp[i]->foo)
-		// and deallocates *tmp[i]
-	}
-	bufferedPoints.clear();
-	
 }
 
 void DacEtherdream :: close() {
 	
 	
     if(isThreadRunning()) {
+        // also stops the thread, after that we're the only
+        // ones talking to the etherdream
+        waitForThread();
         if(connected) {
-            if(lock()) {
-                sendStop();
-                unlock();
-                waitForAck('s');
+            sendStop();
+            // picks up the ack, along with any others still in flight.
+            // They can come back in more than one go, so keep reading
+            // until they're all back or we've waited long enough
+            uint64_t starttime = ofGetElapsedTimeMicros();
+            while((!pendingCommands.empty()) && (ofGetElapsedTimeMicros()-starttime<500000)) {
+                if(!receiveResponses(true)) break;
             }
         }
-        // also stops the thread :
-        waitForThread();
     }
 		
 	socket.close();
@@ -146,6 +152,8 @@ void DacEtherdream :: setup(string _id, string _ip) {
 	if(connected) {
 		//prepareSent = false;
 		beginSent = false;
+		clearPendingCommands();
+		latencyControl.reset();
 		startThread(); // blocking is true by default I think?
 		
 		auto & thread = getNativeThread();
@@ -195,7 +203,8 @@ bool DacEtherdream:: sendFrame(const vector<Point>& points){
 //	ofLog(OF_LOG_NOTICE, "point create count  : " + ofToString(dac_point::createCount));
 //	ofLog(OF_LOG_NOTICE, "point destroy count : " + ofToString(dac_point::destroyCount));
 	//int maxBufferSize = 1000;
-	dac_point& p1 = sendpoint;
+	dac_point p1;
+	p1.control = 0;
 	
 	// if we already have too many points in the buffer,
 	// then it means that we need to skip this frame
@@ -220,7 +229,7 @@ bool DacEtherdream:: sendFrame(const vector<Point>& points){
 				p1.u2 = 0;
 				//addPoint(p1);
 				
-				framePoints[i] = p1;
+				framePoints[i] = etherdreamWirePoint(p1);
 			}
 			newFrame = true;
 			unlock();
@@ -235,11 +244,8 @@ bool DacEtherdream:: sendFrame(const vector<Point>& points){
 
 inline bool DacEtherdream :: sendData(){
 	
-	//data_command d;
-	uint8_t command = 'd';
-	
 	// numPointsToSend is automatically calculated when we get data back from the DAC
-	uint16_t npointstosend = numPointsToSend;
+	int npointstosend = numPointsToSend;
 	
 	// this is to stop sending too many points into the future
 	//float bufferTime = 0.5f; // was 0.1f - TODO make this a param!
@@ -259,7 +265,7 @@ inline bool DacEtherdream :: sendData(){
 	if(frameMode) {
 		
 		// send as many points as we can,
-		npointstosend = MIN(bufferedPoints.size(), numPointsToSend);
+		npointstosend = MIN((int)bufferedPoints.size(), numPointsToSend);
 		
 		// now calculate the min points before we send the new frame...
 		// if we have a new frame, then send it as long as we have spare points
@@ -267,91 +273,75 @@ inline bool DacEtherdream :: sendData(){
 		if(newFrame) {
 			minpointcount = numPointsToSend;
 		} else { // otherwise just send it if we're at the absolute minimum
-			minpointcount = MAX(minBuffer - response.status.buffer_fullness,0);
+			minpointcount = MAX(minBuffer - estimatedBufferFullness,0);
 		}
+		// can't send more than there's room for
+		minpointcount = MIN(minpointcount, numPointsToSend);
 		
 		while((framePoints.size()>0) && (npointstosend<minpointcount)) {
 			//cout << npointstosend << " " << minpointcount << endl;
 			// send the frame!
-			for(size_t i= 0; i<framePoints.size(); i++) {
-				addPoint(framePoints[i]);
-			}
+			bufferedPoints.push(framePoints.data(), framePoints.size());
 			newFrame = false;
-			npointstosend = MIN(bufferedPoints.size(), numPointsToSend);
+			npointstosend = MIN((int)bufferedPoints.size(), numPointsToSend);
 		
 		}
 		
 		
 	}
-	outbuffer[0]= command;
-	writeUInt16ToBytes(npointstosend, &outbuffer[1]);
-	int pos = 3;
-	
-	dac_point& p = sendpoint;
+	// the point count in the header is only 16 bit
+	if(npointstosend>65535) npointstosend = 65535;
+	// nothing to do
+	if(npointstosend==0) return false;
 	
-	for(int i = 0; i<npointstosend; i++) {
-		
-		if(bufferedPoints.size()>0) {
-			p = *bufferedPoints[0]; // copy assignment
-			sparePoints.push_back(bufferedPoints[0]); // recycling system
-			bufferedPoints.pop_front(); // no longer destroys point
-			lastpoint = p; //
-		} else  {
-			// just send some blank points in the same position as the
-			// last point
-			// TODO count the blanks!
-			
-			p = lastpoint;
-			
-			p.i = 0;
-			p.r = 0;
-			p.g = 0;
-			p.b = 0;
-			p.u1 = 0;
-			p.u2 = 0;
+	if((int)bufferedPoints.size()<npointstosend) {
+		// just send some blank points in the same position as the
+		// last point
+		dac_point blank = lastpoint;
+		blank.control = 0;
+		blank.r = blank.g = blank.b = 0;
+		blank.i = blank.u1 = blank.u2 = 0;
+		blankPointCount += npointstosend - (int)bufferedPoints.size();
+		while((int)bufferedPoints.size()<npointstosend) {
+			bufferedPoints.push(blank);
 		}
-		
-		if(queuedPPSChangeMessages>0) {
-			// bit 15 is a flag to tell the DAC about a new point rate
-			p.control = 0b1000000000000000;
-			queuedPPSChangeMessages--;
-		}
-		
-		writeUInt16ToBytes(p.control, &outbuffer[pos]);
-		pos+=2;
-		writeInt16ToBytes(p.x, &outbuffer[pos]);
-		pos+=2;
-		writeInt16ToBytes(p.y, &outbuffer[pos]);
-		pos+=2;
-		writeUInt16ToBytes(p.r, &outbuffer[pos]);
-		pos+=2;
-		writeUInt16ToBytes(p.g, &outbuffer[pos]);
-		pos+=2;
-		writeUInt16ToBytes(p.b, &outbuffer[pos]);
-		pos+=2;
-		writeUInt16ToBytes(p.i, &outbuffer[pos]);
-		pos+=2;
-		writeUInt16ToBytes(p.u1, &outbuffer[pos]);
-		pos+=2;
-		writeUInt16ToBytes(p.u2, &outbuffer[pos]);
-		pos+=2;
-		
 	}
 	
-	numBytesSent = pos;
-	if(numBytesSent>=100000) {
-		
-		ofLog(OF_LOG_ERROR, "ofxLaser::DacEtherdream - too many bytes to send! - " + ofToString(numBytesSent));
+	if(npointstosend>0) {
+		lastpoint = bufferedPoints[npointstosend-1];
+		lastpoint.control = 0;
+	}
+	// bit 15 is a flag to tell the DAC about a new point rate
+	for(int i = 0; (i<npointstosend) && (queuedPPSChangeMessages>0); i++) {
+		bufferedPoints[i].control = etherdreamWire16(0b1000000000000000);
+		queuedPPSChangeMessages--;
 	}
 	
+	uint16_t count = npointstosend;
+	outbuffer[0] = 'd';
+	writeUInt16ToBytes(count, &outbuffer[1]);
+	
 	if(verbose) {
 		ofLogNotice("sending points : " + ofToString(npointstosend));
+		logData(npointstosend);
 	}
 	
-	//cout << "sent " << numBytesSent << " bytes" << endl;
-	return sendBytes(outbuffer, numBytesSent);
+	// the header and then the points straight out of the buffer, in one
+	// or two pieces depending on whether they wrap around
+	dac_point* first;
+	dac_point* second;
+	size_t firstcount, secondcount;
+	bufferedPoints.getSlices(npointstosend, first, firstcount, second, secondcount);
+	
+	const uint8_t* buffers[3] = {outbuffer, (const uint8_t*)first, (const uint8_t*)second};
+	size_t lengths[3] = {3, firstcount*sizeof(dac_point), secondcount*sizeof(dac_point)};
+	
+	bool success = sendBytes(buffers, lengths, (secondcount>0) ? 3 : 2);
+	bufferedPoints.consume(npointstosend);
+	if(success) addPendingCommand('d', npointstosend);
+	
+	return success;
 	
-	//cout << "numPointsToSend " << numPointsToSend << endl;
 }
 
 
@@ -402,15 +392,15 @@ inline bool DacEtherdream :: addPoint(const dac_point &point ){
 		//}
 	//}
 	
-	dac_point* p = getDacPoint();
-	*p = point; // copy assignment hopefully!
-	bufferedPoints.push_back(p);
+	bufferedPoints.push(etherdreamWirePoint(point));
 	return true;
 }
 
 
 void DacEtherdream :: threadedFunction(){
 	
+	// the etherdream sends us its status as soon as we connect
+	addPendingCommand('?');
 	waitForAck('?');
 	
 	bool needToSendPrepare = true;
@@ -441,6 +431,10 @@ void DacEtherdream :: threadedFunction(){
 			} catch(...) {
 				// doesn't matter
 			}
+			// anything still in flight is lost now
+			clearPendingCommands();
+			// and the network might not be the same, so start measuring again
+			latencyControl.reset();
 			sendPing();
 			waitForAck('?');
 			if(response.status.light_engine_state == LIGHT_ENGINE_ESTOP) {
@@ -450,22 +444,20 @@ void DacEtherdream :: threadedFunction(){
 			prepareSendCount = 0;
 			
 			// clear frame
-            dac_point lastPoint;
+            dac_point lastPoint = {};
             if(framePoints.size()>0) {
-                lastPoint = framePoints[0];
+                lastPoint = framePoints[0]; // already in wire format
                
             } else {
                 lastPoint.x = 400;
                 lastPoint.y = 400;
+                lastPoint = etherdreamWirePoint(lastPoint);
             }
             lastPoint.r = 0;
             lastPoint.g = 0;
             lastPoint.b = 0;
             
-			for(dac_point* point : bufferedPoints) {
-                *point = lastPoint;
-				
-			}
+			bufferedPoints.fill(lastPoint);
 			
 		}
 
@@ -473,8 +465,9 @@ void DacEtherdream :: threadedFunction(){
 			needToSendPrepare = true;
 		}
 		
-		if(needToSendPrepare) {
-			;
+		// prepare can't be pipelined, so wait til everything in flight
+		// has been answered
+		if(needToSendPrepare && pendingCommands.empty()) {
 			bool success = (sendPrepare()	&& waitForAck('p'));
 			
 			if( success ) {
@@ -485,44 +478,64 @@ void DacEtherdream :: threadedFunction(){
 		}
 		
 		// if we're playing and we have a new point rate, send it!
-		if(connected && (response.status.playback_state==PLAYBACK_PLAYING) && (newPPS!=pps)) {
-			
+		// the etherdream deals with commands in order so the new rate takes
+		// effect before any of the points we send after it
+		if(connected && (response.status.playback_state==PLAYBACK_PLAYING) && (newPPS!=pps) && !isCommandPending('q')) {
 			
-			if(sendPointRate(pps)){
+			if(sendPointRate(newPPS)){
 				pps = newPPS;
-				waitForAck('q');
 				queuedPPSChangeMessages++;
 			}
 			
-			
 		}
 		
-		// if state is prepared or playing, and we have points in the buffer, then send the points
-		if(connected && (response.status.playback_state!=PLAYBACK_IDLE)) {
+		// if state is prepared or playing, and there's room in the buffer, then send the points.
+		// We don't wait for the ack, so there can be a few of these in flight at once
+		bool sentData = false;
+		if(connected && (response.status.playback_state!=PLAYBACK_IDLE) && (dataCommandsInFlight<maxDataCommandsInFlight)) {
 			
-			// min buffer amount
-			if(numPointsToSend>pointsToSendBeforePlaying){
+			if(adaptiveLatency) {
+				dacBufferSize = latencyControl.update(pps, minPointsPerPacket, ofGetElapsedTimeMicros());
+				// start playing once it's half full
+				pointsToSendBeforePlaying = dacBufferSize/2;
+			}
+			updateNumPointsToSend();
+			// min packet size, no point in sending tiny packets
+			if(numPointsToSend>=minPointsPerPacket){
 				//check buffer and send the next points
 				while(!lock()) {}
-				sendData();
+				sentData = sendData();
 				unlock();
-				waitForAck('d');
-			} else if(isThreadRunning()) {
-				// if we're not sending data, then let's ping the etherdream so it can
-				// tell us how many points can fit into its buffer.
-				sendPing(); // ping is '?' character
-				waitForAck('?');
 			}
 			
 		}
 		// if state is prepared and we have sent enough points and we haven't already, send begin
-		if(connected && (response.status.playback_state==PLAYBACK_PREPARED) && (response.status.buffer_fullness>=pointsToSendBeforePlaying)) {
+		if(connected && (response.status.playback_state==PLAYBACK_PREPARED) && (response.status.buffer_fullness>=pointsToSendBeforePlaying) && !isCommandPending('b')) {
 			sendBegin();
-			beginSent = waitForAck('b');
-
-			
 		}
 		
+		if(connected) {
+			if(pendingCommands.empty() && isThreadRunning()) {
+				// if it's playing and the buffer's full then there's no point asking
+				// until there's room for another packet, so have a little sleep
+				int waitMicros = 0;
+				if((response.status.playback_state==PLAYBACK_PLAYING) && (response.status.point_rate>0)) {
+					waitMicros = (int64_t)(minPointsPerPacket-numPointsToSend)*1000000/response.status.point_rate;
+					waitMicros = MIN(waitMicros, 5000);
+				}
+				if(waitMicros>0) {
+					std::this_thread::sleep_for(std::chrono::microseconds(waitMicros));
+				} else {
+					// if we're not sending anything, then let's ping the etherdream so it can
+					// tell us how many points can fit into its buffer.
+					sendPing(); // ping is '?' character
+				}
+			}
+			// if we can't send any more data, wait for the next reply, otherwise
+			// just deal with any replies that have already arrived
+			bool block = (!sentData) || (dataCommandsInFlight>=maxDataCommandsInFlight);
+			if(pendingCommands.size()>0) receiveResponses(block);
+		}
 		
 		if(!connected) {
 			if(socket.available()) {
@@ -558,139 +571,140 @@ bool DacEtherdream::setPointsPerSecond(uint32_t newpps){
 
 inline bool DacEtherdream::waitForAck(char command) {
 	
-	// TODO :
-	
-	// ADD TIMEOUT!
+	// waits until everything we've sent has been acknowledged, so the
+	// last response will be for this command. Only used for the commands
+	// that can't be pipelined, the data gets sent without waiting.
+	while(pendingCommands.size()>0) {
+		if(!isThreadRunning()) return false;
+		if(!receiveResponses(true)) return false;
+	}
+	if(response.command!=command) {
+		ofLog(OF_LOG_WARNING, "DacEtherdream::waitForAck - expected ack for " + ofToString(command) + " got " + ofToString(response.command));
+	}
+	return true;
 	
-	// keep parsing buffer data
-	// check validity of response
-	// if response not valid then clear buffer and send ping?
+}
+
+bool DacEtherdream :: receiveResponses(bool block) {
 	
-	// basically this just waits til there's stuff in the socket
-	// to read. Bit of code gymnastics because I was getting
-	// an error when closing the socket.
+	if(!block && (socket.available()<=0)) return true;
 	
-	bool waiting = true;
+	int n = 0;
 	bool failed = false;
-//	int count = 0;
-//	int timeoutwait = 1000;// one second - ish
-//	while(waiting && !failed) {
-//
-//
-//		if(lock()) {
-//            if(socket.available()){
-//				waiting = false;
-//            }
-//			unlock();
-//		}
-//
-//		if(!isThreadRunning()) return false;
-//
-//        if(waiting) {
-//            yield();
-//            sleep(1);
-//			//count++;
-//        }
-//
-////		if(count > timeoutwait) {
-////			failed = true;
-////			ofLog(OF_LOG_WARNING, "DACEtherdream.waitForAck timeout)" );
-////
-////		}
-//	}
 	
+	try {
+		// this blocks until it gets some bytes or times out
+		n = socket.receiveBytes(buffer+receivedByteCount, sizeof(buffer)-receivedByteCount);
+	} catch (Poco::TimeoutException& exc) {
+		//Handle your network errors.
+		ofLog(OF_LOG_ERROR,  "Timeout error: " + exc.displayText());
+		failed = true;
+	} catch (Poco::Exception& exc) {
+		//Handle your network errors.
+		ofLog(OF_LOG_ERROR,  "Network error: " + exc.displayText());
+		failed = true;
+	}
+	
+	// this should mean that the socket has been closed...
+	if(n<=0) failed = true;
+	else receivedByteCount+=n;
 	
-	int n = 0;
-    while ((n==0) && (!failed)) {
-		if(!isThreadRunning()) return false;
-		// i think this should block until it gets bytes
+	// responses are always 22 bytes but they can arrive split up or
+	// several at a time, so parse all the complete ones and keep the rest
+	int pos = 0;
+	while(!failed && (receivedByteCount-pos>=22)) {
+		if(!processResponse(&buffer[pos])) failed = true;
+		pos+=22;
+	}
+	if(pos>0) {
+		receivedByteCount-=pos;
+		memmove(buffer, buffer+pos, receivedByteCount);
+	}
+	
+	if(failed) {
+		beginSent = false;
+		connected = false;
 		
-		try {
-			n = socket.receiveBytes(buffer, 22);
-			lastMessageTimeMicros = ofGetElapsedTimeMicros();
-			latencyMicros = lastMessageTimeMicros - startTime;
-		} catch (Poco::Exception& exc) {
-			//Handle your network errors.
-			ofLog(OF_LOG_ERROR,  "Network error: " + exc.displayText());
-			//	isOpen = false;
-			failed = true;
-		} catch (Poco::TimeoutException& exc) {
-			//Handle your network errors.
-			ofLog(OF_LOG_ERROR,  "Timeout error: " + exc.displayText());
-			//	isOpen = false;
-			failed = true;
-			
-		}
+		return false;
+	} else {
 		
-		// this should mean that the socket has been closed...
-        if((n==0) || (failed)) {
-            //yield();
-		    //sleep(1);
-			//ofLog(OF_LOG_ERROR,  "Socket disconnected");
-			failed = true;
-			
-		}
-		//count ++;
-	
-		//if(count > timeoutwait) {
-		//	failed = true;
-		//	ofLog(OF_LOG_WARNING, "DACEtherdream.waitForAck timeout)" );
-			
-		//}
+		return true;
 	}
-	// = count;
-	// TODO - handle incomplete data
+}
+
+bool DacEtherdream :: processResponse(const uint8_t* data) {
 	
-	//cout << "received " << n << "bytes" <<endl;
+	bool failed = false;
+	uint64_t now = ofGetElapsedTimeMicros();
+	uint8_t previousplaybackstate = response.status.playback_state;
+	uint16_t previousplaybackflags = response.status.playback_flags;
 	
-	if(n==22) {
-		
-		connected = true;
-		response.response = buffer[0];
-		response.command = buffer[1];
-		response.status.protocol = buffer[2];
-		response.status.light_engine_state = buffer[3];
-		response.status.playback_state = buffer [4];
-		response.status.source = buffer[5];
-		response.status.light_engine_flags = bytesToUInt16(&buffer[6]);
-		response.status.playback_flags =  bytesToUInt16(&buffer[8]);
-		response.status.source_flags =  bytesToUInt16(&buffer[10]);
-		response.status.buffer_fullness = bytesToUInt16(&buffer[12]);
-		response.status.point_rate = bytesToUInt32(&buffer[14]);
-		response.status.point_count = bytesToUInt32(&buffer[18]);
-		
-        if((response.response == 'a') && (response.status.playback_state!= PLAYBACK_IDLE )) {
-            numPointsToSend = dacBufferSize - response.status.buffer_fullness;
-            if(numPointsToSend<0) numPointsToSend = 0;
-			
-//			// numpointstosend should be
-//			if((bufferedPoints.size()>minBuffer) && (numPointsToSend>bufferedPoints.size())) {
-//				numPointsToSend
-//			}
-			
-        }
-		
-		if(verbose) {
-			if(command == 'd') logData();
+	connected = true;
+	response.response = data[0];
+	response.command = data[1];
+	response.status.protocol = data[2];
+	response.status.light_engine_state = data[3];
+	response.status.playback_state = data[4];
+	response.status.source = data[5];
+	response.status.light_engine_flags = bytesToUInt16((unsigned char*)&data[6]);
+	response.status.playback_flags =  bytesToUInt16((unsigned char*)&data[8]);
+	response.status.source_flags =  bytesToUInt16((unsigned char*)&data[10]);
+	response.status.buffer_fullness = bytesToUInt16((unsigned char*)&data[12]);
+	response.status.point_rate = bytesToUInt32((unsigned char*)&data[14]);
+	response.status.point_count = bytesToUInt32((unsigned char*)&data[18]);
+	lastMessageTimeMicros = now;
+	
+	// how full the buffer was before this command added any points
+	int fullnessbefore = response.status.buffer_fullness;
+	
+	// the etherdream answers everything in order so this should be the
+	// response to the oldest command we sent
+	if(pendingCommands.size()>0) {
+		EtherdreamPendingCommand& pending = pendingCommands.front();
+		if(pending.command!=response.command) {
+			ofLog(OF_LOG_WARNING, "DacEtherdream - response out of order, expected " + ofToString(pending.command) + " got " + ofToString(response.command));
 		}
-		
-		if(verbose || (response.response!='a')) {
+		latencyMicros = now - pending.sentTimeMicros;
+		commandLatencyMicros[(uint8_t)pending.command] = latencyMicros;
+		if(pending.command=='d') {
+			pointsInFlight-=pending.numPoints;
+			dataCommandsInFlight--;
+			fullnessbefore-=pending.numPoints;
+		}
+		pendingCommands.pop_front();
+		latencyControl.addRoundTrip(latencyMicros);
+	}
+	
+	// if it's flagged an underflow, or stopped playing without us telling
+	// it to, then it's run out of points
+	bool underflow = (response.status.playback_flags & 0b010) && !(previousplaybackflags & 0b010);
+	if((previousplaybackstate==PLAYBACK_PLAYING) && (response.status.playback_state!=PLAYBACK_PLAYING) && (response.command!='s')) {
+		underflow = true;
+	}
+	if(underflow) {
+		underflowCount++;
+		latencyControl.addUnderflow(now);
+	} else if((response.response=='a') && (response.status.playback_state==PLAYBACK_PLAYING)) {
+		latencyControl.addBufferFullness(fullnessbefore);
+	}
+	
+	if(verbose || (response.response!='a')) {
             ofLog(OF_LOG_NOTICE, "response : "+ ofToString(response.response) +  " command : " + ofToString(response.command) );
 //            ofLog(OF_LOG_NOTICE, "num points sent : "+ ofToString(numPointsToSend) );
 //
-			string data = "";
-			data+= "\nprotocol           : " + to_string(response.status.protocol) + "\n";
-			data+= "light_engine_state : " + light_engine_states[response.status.light_engine_state]+" "+to_string(response.status.light_engine_state) + "\n";
-			data+= "playback_state     : " + playback_states[response.status.playback_state]+" "+to_string(response.status.playback_state) + "\n";
-			data+= "source             : " + to_string(response.status.source) + "\n";
-			data+= "light_engine_flags : " + std::bitset<5>(response.status.light_engine_flags).to_string() + "\n";
-			data+= "playback_flags     : " + std::bitset<3>(response.status.playback_flags).to_string() + "\n";
-			data+= "source_flags       : " + to_string(response.status.source_flags) + "\n";
-			data+= "buffer_fullness    : " + to_string(response.status.buffer_fullness) + "\n";
-			data+= "point_rate         : " + to_string(response.status.point_rate) + "\n";
-			data+= "point_count        : " + to_string(response.status.point_count) + "\n";
-			
-			cout << data << endl;
+		string data = "";
+		data+= "\nprotocol           : " + to_string(response.status.protocol) + "\n";
+		data+= "light_engine_state : " + light_engine_states[response.status.light_engine_state]+" "+to_string(response.status.light_engine_state) + "\n";
+		data+= "playback_state     : " + playback_states[response.status.playback_state]+" "+to_string(response.status.playback_state) + "\n";
+		data+= "source             : " + to_string(response.status.source) + "\n";
+		data+= "light_engine_flags : " + std::bitset<5>(response.status.light_engine_flags).to_string() + "\n";
+		data+= "playback_flags     : " + std::bitset<3>(response.status.playback_flags).to_string() + "\n";
+		data+= "source_flags       : " + to_string(response.status.source_flags) + "\n";
+		data+= "buffer_fullness    : " + to_string(response.status.buffer_fullness) + "\n";
+		data+= "point_rate         : " + to_string(response.status.point_rate) + "\n";
+		data+= "point_count        : " + to_string(response.status.point_count) + "\n";
+		
+		cout << data << endl;
             
             // EDGE CASE THAT WE NEED TO CATCH :
             
@@ -706,7 +720,11 @@ inline bool DacEtherdream::waitForAck(char command) {
             // send the frame again?
             // or just send a load of blank points at the start of the next points?
             
-            if(response.response=='I') {
+            // We don't treat it as a disconnection any more, the status
+            // says it's idle so the thread sends a prepare once all the
+            // other commands in flight have been answered. Only the data
+            // that was refused is lost.
+            if((response.response=='I') && (response.status.playback_state!=PLAYBACK_IDLE)) {
                 
                 // ofLog(OF_LOG_ERROR, ofToString(outbuffer));
                 //logData();
@@ -715,81 +733,116 @@ inline bool DacEtherdream::waitForAck(char command) {
                 
             }
                 
-		}
-		// things we /are/ interested in in this response data :
-		//
-		// light_engine_state :
-		// ====================
-		// 0 : ready
-		// 1 : warmup
-		// 2 : cooldown
-		// 3 : Emergency stop
-		//
-		// I've only ever seen it as 0, I don't think warmup and cooldown are implemented. Emergency stop
-		// only happens if you send a 0x00 command or an 0xff command (or any command it doesn't recognise
-		//
-		// light_engine_flags :
-		// ====================
-		// 00001 : Emergency stop due to E-Stop packet (or weird command)
-		// 00010 : Emergency stop due to E-Stop input to projector (not sure how etherdream would know?)
-		// 00100 : Emergency stop input to projector is currently active (no idea what this means)
-		// 01000 : Emergency stop due to over temperature (interesting... probably worth looking into...)
-		// 10000 : Emergency stop due to loss of Ethernet (not sure how we'd get the message? unless this is
-		//		   sent after a reconnection)
-		//
-		// playback_state :
-		// ================
-		// 0 : Idle
-		// 1 : Prepared
-		// 2 : Playing
-		//
-		// So zero is the default. In idle, you can't send point data.
-		// Prepared means we can start sending points
-		// Playing is when we're prepared, have sent data, and started streaming
-		//
-		// playback_flags :
-		// ================
-		// Bit # :
-		// 001 : Shutter state (1 for open, 0 for closed)
-		// 010 : Underflow - the most common, is 1 if the system runs out of points
-		// 100 : E-Stop - happens if you send a stop command (or any weird bytes). Worth keeping an eye on
-		//
-		// buffer_fullness :
-		// =================
-		// This is how many points are queued up in the buffer. Seems to be a limit of 1799.
-		//
-		// point_rate :
-		// ============
-		// whatever the current point rate is set to
-		//
-		// point_count :
-		// =============
-		// The number of points it has processed - I wonder what happens when this is clocked?
-		// It gets reset on a prepare.
-		//
-		// things we aren't interested in :
-		// ================================
-		// protocol - always seems to be zero
-		// source - always 0 for data stream. Could be 1 for ilda playback from SD card or 2 for internal abstract generator (no idea what that is but it sounds cool!)
-		// source_flags - no idea what this even is. No docs about it.
-		
-		
 	}
-	else {
-		ofLog(OF_LOG_NOTICE, "data received from Etherdream not 22 bytes :" + ofToString(n));
-		// what do we do now?
-		
+	// things we /are/ interested in in this response data :
+	//
+	// light_engine_state :
+	// ====================
+	// 0 : ready
+	// 1 : warmup
+	// 2 : cooldown
+	// 3 : Emergency stop
+	//
+	// I've only ever seen it as 0, I don't think warmup and cooldown are implemented. Emergency stop
+	// only happens if you send a 0x00 command or an 0xff command (or any command it doesn't recognise
+	//
+	// light_engine_flags :
+	// ====================
+	// 00001 : Emergency stop due to E-Stop packet (or weird command)
+	// 00010 : Emergency stop due to E-Stop input to projector (not sure how etherdream would know?)
+	// 00100 : Emergency stop input to projector is currently active (no idea what this means)
+	// 01000 : Emergency stop due to over temperature (interesting... probably worth looking into...)
+	// 10000 : Emergency stop due to loss of Ethernet (not sure how we'd get the message? unless this is
+	//		   sent after a reconnection)
+	//
+	// playback_state :
+	// ================
+	// 0 : Idle
+	// 1 : Prepared
+	// 2 : Playing
+	//
+	// So zero is the default. In idle, you can't send point data.
+	// Prepared means we can start sending points
+	// Playing is when we're prepared, have sent data, and started streaming
+	//
+	// playback_flags :
+	// ================
+	// Bit # :
+	// 001 : Shutter state (1 for open, 0 for closed)
+	// 010 : Underflow - the most common, is 1 if the system runs out of points
+	// 100 : E-Stop - happens if you send a stop command (or any weird bytes). Worth keeping an eye on
+	//
+	// buffer_fullness :
+	// =================
+	// This is how many points are queued up in the buffer. Seems to be a limit of 1799.
+	//
+	// point_rate :
+	// ============
+	// whatever the current point rate is set to
+	//
+	// point_count :
+	// =============
+	// The number of points it has processed - I wonder what happens when this is clocked?
+	// It gets reset on a prepare.
+	//
+	// things we aren't interested in :
+	// ================================
+	// protocol - always seems to be zero
+	// source - always 0 for data stream. Could be 1 for ilda playback from SD card or 2 for internal abstract generator (no idea what that is but it sounds cool!)
+	// source_flags - no idea what this even is. No docs about it.
+
+	return !failed;
+}
+
+void DacEtherdream :: addPendingCommand(char command, int numpoints) {
+	
+	EtherdreamPendingCommand pending;
+	pending.command = command;
+	pending.numPoints = numpoints;
+	pending.sentTimeMicros = ofGetElapsedTimeMicros();
+	pendingCommands.push_back(pending);
+	if(command=='d') {
+		pointsInFlight+=numpoints;
+		dataCommandsInFlight++;
 	}
+}
+
+void DacEtherdream :: clearPendingCommands() {
+	pendingCommands.clear();
+	pointsInFlight = 0;
+	dataCommandsInFlight = 0;
+	receivedByteCount = 0;
+}
+
+void DacEtherdream :: updateNumPointsToSend() {
 	
-	if(failed) {
-		beginSent = false;
-		connected = false;
-		
-		return false;
-	} else {
-		
-		return true;
+	// the last status is out of date by now, so allow for the points
+	// it's played since then and the points that are still on their way
+	int fullness = response.status.buffer_fullness;
+	if(response.status.playback_state==PLAYBACK_PLAYING) {
+		fullness -= (float)((ofGetElapsedTimeMicros()-lastMessageTimeMicros)*response.status.point_rate)/1000000.0f;
+		if(fullness<0) fullness = 0;
 	}
+	estimatedBufferFullness = fullness + pointsInFlight;
+	numPointsToSend = dacBufferSize - estimatedBufferFullness;
+	if(numPointsToSend<0) numPointsToSend = 0;
+	
+}
+
+bool DacEtherdream :: isCommandPending(char command) {
+	for(EtherdreamPendingCommand& pending : pendingCommands) {
+		if(pending.command==command) return true;
+	}
+	return false;
+}
+
+int DacEtherdream :: getOutputLatencyMicros() {
+	if(pps==0) return 0;
+	return ((int64_t)estimatedBufferFullness*1000000/pps) + (latencyControl.getRoundTripMicros()/2);
+}
+
+int DacEtherdream :: getCommandLatencyMicros(char command) {
+	return commandLatencyMicros[(uint8_t)command];
 }
 
 string DacEtherdream ::getId(){
@@ -814,16 +867,17 @@ inline bool DacEtherdream :: sendBegin(){
 	b.low_water_mark = 0 ;
 	b.point_rate = pps;
 	
-	buffer[0] = b.command;
-	writeUInt16ToBytes(b.low_water_mark, &buffer[1]);
-	writeUInt32ToBytes(b.point_rate, &buffer[3]);
+	outbuffer[0] = b.command;
+	writeUInt16ToBytes(b.low_water_mark, &outbuffer[1]);
+	writeUInt32ToBytes(b.point_rate, &outbuffer[3]);
 	
 	//	for(int i = 0; i<7;i++) {
-	//		cout << i << ":" <<buffer[i]<< "(" << std::dec << (int)buffer[i] << std::dec <<")\n";
+	//		cout << i << ":" <<outbuffer[i]<< "(" << std::dec << (int)outbuffer[i] << std::dec <<")\n";
 	//	}
 	
 	//int n = socket->sendBytes(&send[0],7);
-	beginSent = sendBytes(buffer, 7);
+	beginSent = sendBytes(outbuffer, 7);
+	if(beginSent) addPendingCommand('b');
 	
 	return beginSent;
 	
@@ -834,7 +888,9 @@ inline bool DacEtherdream :: sendPrepare(){
 	ofLog(OF_LOG_NOTICE, "sendPrepare()");
 	prepareSendCount++;
 	uint8_t send = 0x70; //'p'
-	return sendBytes(&send,1);
+	if(!sendBytes(&send,1)) return false;
+	addPendingCommand('p');
+	return true;
 	//cout << "sent " << n << " bytes" << endl;
 	//prepareSent = true;
 
@@ -844,62 +900,60 @@ inline bool DacEtherdream :: sendPrepare(){
 inline bool DacEtherdream :: sendPointRate(uint32_t rate){
 	outbuffer[0] = 'q';
 	writeUInt32ToBytes(rate, &outbuffer[1]);
-	return sendBytes(outbuffer, 5);
+	if(!sendBytes(outbuffer, 5)) return false;
+	addPendingCommand('q');
+	return true;
 	
 }
 
-void DacEtherdream :: logData() {
-    //bytesToUInt16(&buffer[8]
+void DacEtherdream :: logData(int numpoints) {
     string data = "---------------------------------------------------------------\n";
     data+= "command            : ";
     data+=(char)outbuffer[0];
     data+= "\n";
-    int numpoints =bytesToUInt16(&outbuffer[1]);
-    data+= "num points         : " + to_string(numpoints) + "\n";
-    int pos = 3;
+    data+= "num points         : " + to_string(bytesToUInt16(&outbuffer[1])) + "\n";
     
     for(int i = 0; i<numpoints; i++) {
+        dac_point p = etherdreamWirePoint(bufferedPoints[i]);
         data+= "------------------------------ npoint # " + to_string(i) + "\n";
-        
-        data+= " ctl : " + to_string(bytesToUInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " x   : " + to_string(bytesToInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " y   : " + to_string(bytesToInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " r   : " + to_string(bytesToUInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " g   : " + to_string(bytesToUInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " b   : " + to_string(bytesToUInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " i   : " + to_string(bytesToUInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " u1   : " + to_string(bytesToUInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
-        data+= " u2   : " + to_string(bytesToUInt16(&outbuffer[pos])) + "\n";
-        pos+=2;
+        data+= " ctl : " + to_string(p.control) + "\n";
+        data+= " x   : " + to_string(p.x) + "\n";
+        data+= " y   : " + to_string(p.y) + "\n";
+        data+= " r   : " + to_string(p.r) + "\n";
+        data+= " g   : " + to_string(p.g) + "\n";
+        data+= " b   : " + to_string(p.b) + "\n";
+        data+= " i   : " + to_string(p.i) + "\n";
+        data+= " u1   : " + to_string(p.u1) + "\n";
+        data+= " u2   : " + to_string(p.u2) + "\n";
     }
     cout << data << endl;
     
 }
 bool DacEtherdream :: sendPing(){
 	uint8_t ping = '?';
-	return sendBytes(&ping, 1);
+	if(!sendBytes(&ping, 1)) return false;
+	addPendingCommand(ping);
+	return true;
 }
 bool DacEtherdream :: sendEStop(){
 	uint8_t ping = '\0';
-	return sendBytes(&ping, 1);
+	if(!sendBytes(&ping, 1)) return false;
+	addPendingCommand(ping);
+	return true;
 }
 bool DacEtherdream :: sendStop(){
 	// non-emergency stop
 	uint8_t ping = 's';
-	return sendBytes(&ping, 1);
+	if(!sendBytes(&ping, 1)) return false;
+	addPendingCommand(ping);
+	return true;
 }
 bool DacEtherdream :: sendClear(){
 	uint8_t ping = 'c';
 	// clear emergency stop
-	return sendBytes(&ping, 1);
+	if(!sendBytes(&ping, 1)) return false;
+	addPendingCommand(ping);
+	return true;
 }
 
 bool DacEtherdream :: sendBytes(const uint8_t* buffer, int length) {
@@ -907,7 +961,6 @@ bool DacEtherdream :: sendBytes(const uint8_t* buffer, int length) {
 	int numBytesSent = 0;
 	bool failed = false;
 	bool networkerror = false;
-    startTime = ofGetElapsedTimeMicros();//  count = 0;
 
 	try {
 		numBytesSent = socket.sendBytes(buffer, length);
@@ -954,6 +1007,89 @@ bool DacEtherdream :: sendBytes(const uint8_t* buffer, int length) {
 	}
 	return true;
 }
+bool DacEtherdream :: sendBytes(const uint8_t* const* buffers, const size_t* lengths, int numbuffers) {
+	
+	bool failed = false;
+	bool networkerror = false;
+	if(numbuffers>3) numbuffers = 3;
+	size_t totallength = 0;
+	for(int i = 0; i<numbuffers; i++) totallength+=lengths[i];
+	
+	size_t numBytesSent = 0;
+	auto sockfd = socket.impl()->sockfd();
+	
+	// keep going until it's all gone, skipping whatever was sent last time
+	// round if we only get a partial write
+	while((numBytesSent<totallength) && !failed) {
+		
+#ifdef _MSC_VER
+		WSABUF slices[3];
+#else
+		struct iovec slices[3];
+#endif
+		int numslices = 0;
+		size_t skip = numBytesSent;
+		for(int i = 0; i<numbuffers; i++) {
+			if(skip>=lengths[i]) {
+				skip-=lengths[i];
+				continue;
+			}
+#ifdef _MSC_VER
+			slices[numslices].buf = (CHAR*)(buffers[i]+skip);
+			slices[numslices].len = (ULONG)(lengths[i]-skip);
+#else
+			slices[numslices].iov_base = (void*)(buffers[i]+skip);
+			slices[numslices].iov_len = lengths[i]-skip;
+#endif
+			numslices++;
+			skip = 0;
+		}
+		
+#ifdef _MSC_VER
+		DWORD n = 0;
+		if(WSASend(sockfd, slices, numslices, &n, 0, NULL, NULL)!=0) {
+			int error = WSAGetLastError();
+			if((error!=WSAETIMEDOUT) && (error!=WSAEWOULDBLOCK)) networkerror = true;
+			cerr << "sendBytes : Network error: " << error << endl;
+			failed = true;
+		} else {
+			numBytesSent+=n;
+		}
+#else
+		struct msghdr message = {};
+		message.msg_iov = slices;
+		message.msg_iovlen = numslices;
+		int flags = 0;
+#ifdef MSG_NOSIGNAL
+		flags = MSG_NOSIGNAL; // don't want a SIGPIPE if the DAC goes away
+#endif
+		ssize_t n = ::sendmsg(sockfd, &message, flags);
+		if(n<0) {
+			if(errno==EINTR) continue;
+			if((errno==EAGAIN) || (errno==EWOULDBLOCK)) {
+				cerr << "sendBytes : Timeout error" << endl;
+			} else {
+				cerr << "sendBytes : Network error: " << strerror(errno) << endl;
+				networkerror = true;
+			}
+			failed = true;
+		} else {
+			numBytesSent+=n;
+		}
+#endif
+	}
+	
+	if(failed) {
+		if(networkerror) {
+			closeWhileRunning();
+			setup(id, ipaddress);
+		}
+		beginSent = false;
+		return false;
+	}
+	return true;
+}
+
 //bool DacEtherdream :: receiveBytes(const void* buffer, int length) {
 //
 //	int numBytesRecieved = 0;
@@ -970,24 +1106,56 @@ bool DacEtherdream :: sendBytes(const uint8_t* buffer, int length) {
 //	}
 //}
 
-dac_point*  DacEtherdream :: getDacPoint() {
-	dac_point* p;
-	if(sparePoints.size()==0) {
-		p= new dac_point();
-		//ofLog(OF_LOG_NOTICE, "new point made");
-	} else {
-		p = sparePoints.back();
-		sparePoints.pop_back();
-		
+void EtherdreamPointBuffer :: reserve(size_t n) {
+	
+	if(n<=storage.size()) return;
+	size_t newcapacity = MAX(storage.size(), (size_t)2048);
+	while(newcapacity<n) newcapacity*=2;
+	
+	// unwrap the existing points into the start of the new storage
+	vector<dac_point> newstorage(newcapacity);
+	for(size_t i = 0; i<count; i++) {
+		newstorage[i] = storage[(start+i) & mask];
 	}
-	p->control =
-	p->x =
-	p->y =
-	p->r =
-	p->g =
-	p->b =
-	p->i =
-	p->u1 =
-	p->u2 = 0;
-	return p;
+	storage.swap(newstorage);
+	start = 0;
+	mask = newcapacity-1;
+	
+}
+
+void EtherdreamPointBuffer :: push(const dac_point* points, size_t n) {
+	
+	if(count+n>storage.size()) reserve(count+n);
+	
+	size_t end = (start+count) & mask;
+	size_t firstcount = MIN(n, storage.size()-end);
+	std::copy(points, points+firstcount, storage.begin()+end);
+	std::copy(points+firstcount, points+n, storage.begin());
+	count+=n;
+	
+}
+
+void EtherdreamPointBuffer :: getSlices(size_t n, dac_point*& first, size_t& firstcount, dac_point*& second, size_t& secondcount) {
+	
+	n = MIN(n, count);
+	first = storage.data()+start;
+	firstcount = MIN(n, storage.size()-start);
+	second = storage.data();
+	secondcount = n-firstcount;
+	
+}
+
+void EtherdreamPointBuffer :: consume(size_t n) {
+	
+	n = MIN(n, count);
+	start = (start+n) & mask;
+	count-=n;
+	if(count==0) start = 0;
+	
+}
+
+void EtherdreamPointBuffer :: fill(const dac_point& point) {
+	for(size_t i = 0; i<count; i++) {
+		storage[(start+i) & mask] = point;
 	}
+}
@@ -8,6 +8,7 @@
 
 #pragma once
 #include "ofxLaserDacBase.h"
+#include "ofxLaserDacEtherdreamLatencyControl.h"
 
 #include "Poco/Net/SocketAddress.h"
 #include "Poco/Net/SocketStream.h"
@@ -82,12 +83,94 @@ struct dac_point {
 	
 };
 
+// the struct is exactly the layout of a point in a 'd' command, so the
+// buffered points can go straight out to the socket
+static_assert(sizeof(dac_point)==18, "dac_point should be the 18 byte Etherdream wire format");
+
+// The Etherdream protocol is little endian, which is what the struct already
+// is in memory on pretty much anything we run on. On a big endian machine
+// the fields get swapped. Works in both directions.
+inline uint16_t etherdreamWire16(uint16_t n) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	return (uint16_t)((n>>8) | (n<<8));
+#else
+	return n;
+#endif
+}
+inline dac_point etherdreamWirePoint(const dac_point& p) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	dac_point w;
+	w.control = etherdreamWire16(p.control);
+	w.x = (int16_t)etherdreamWire16((uint16_t)p.x);
+	w.y = (int16_t)etherdreamWire16((uint16_t)p.y);
+	w.r = etherdreamWire16(p.r);
+	w.g = etherdreamWire16(p.g);
+	w.b = etherdreamWire16(p.b);
+	w.i = etherdreamWire16(p.i);
+	w.u1 = etherdreamWire16(p.u1);
+	w.u2 = etherdreamWire16(p.u2);
+	return w;
+#else
+	return p;
+#endif
+}
+
 
 
 
 
 namespace ofxLaser {
 
+	// A ring buffer of points, already in wire format. The storage is one
+	// contiguous block so the next n points are always either one or two
+	// slices of memory that can be handed straight to the socket.
+	class EtherdreamPointBuffer {
+		
+		public :
+		
+		size_t size() const { return count; }
+		size_t capacity() const { return storage.size(); }
+		void clear() { start = count = 0; }
+		
+		// makes room for at least n points, keeping the ones already in there
+		void reserve(size_t n);
+		
+		inline void push(const dac_point& point) {
+			if(count==storage.size()) reserve(count+1);
+			storage[(start+count) & mask] = point;
+			count++;
+		}
+		// copies a block of points in, in at most two chunks
+		void push(const dac_point* points, size_t n);
+		
+		// the next n points (up to size()) as one or two contiguous
+		// slices. If it doesn't wrap, the second slice is empty.
+		void getSlices(size_t n, dac_point*& first, size_t& firstcount, dac_point*& second, size_t& secondcount);
+		// removes n points from the front
+		void consume(size_t n);
+		
+		// sets all of the buffered points to the same point
+		void fill(const dac_point& point);
+		
+		dac_point& operator[](size_t i) { return storage[(start+i) & mask]; }
+		
+		protected :
+		
+		// always a power of two so we can wrap with the mask
+		vector<dac_point> storage;
+		size_t start = 0;
+		size_t count = 0;
+		size_t mask = 0;
+		
+	};
+
+	// a command that's been sent but hasn't been acknowledged yet
+	struct EtherdreamPendingCommand {
+		char command;
+		int numPoints; // only for data commands
+		uint64_t sentTimeMicros;
+	};
+
 	class DacEtherdream : public DacBase, ofThread {
 	
 	public:
@@ -113,15 +196,14 @@ namespace ofxLaser {
 		
 		void reset() override; 
         
-        //output the data that we just sent
-        void logData();
-		
-		// simple object pooling system
-		dac_point* getDacPoint();
+        //output the data that we're about to send
+        void logData(int numpoints);
 		
 		ofParameter<int> pointBufferDisplay;
 		ofParameter<int> latencyDisplay;
 		ofParameter<int> reconnectCount;
+		ofParameter<int> targetBufferDisplay;
+		ofParameter<int> outputLatencyDisplay;
 		uint64_t lastMessageTimeMicros;
 		
         
@@ -132,7 +214,30 @@ namespace ofxLaser {
 		// the minimum number of points in the buffer before the etherdream
 		// starts playing.
 		int pointsToSendBeforePlaying;
+		// how many data commands we can send before we have to wait for
+		// an ack. More helps keep the buffer topped up on slow networks
+		int maxDataCommandsInFlight;
+		// don't bother sending data until there's room for at least this
+		// many points
+		int minPointsPerPacket;
+		
+		// the round trip time for the last command of each type ('d', '?' etc)
+		int getCommandLatencyMicros(char command);
+		
+		// if this is on, latencyControl sets dacBufferSize and
+		// pointsToSendBeforePlaying, depending on how the network is doing,
+		// so anything you've set them to is overwritten. Off by default.
+		bool adaptiveLatency;
+		EtherdreamLatencyControl latencyControl;
+		// roughly how long it takes for a point we send to come out of the
+		// laser, ie the network plus everything that's queued up in front of it
+		int getOutputLatencyMicros();
+		int getUnderflowCount() { return underflowCount; }
+		// the number of blank points we've had to send because we ran out
+		// of frame points
+		int getBlankPointCount() { return blankPointCount; }
 
+		// in wire format, so they can be copied straight into the buffer
 		vector<dac_point> framePoints;
         
         
@@ -182,14 +287,28 @@ namespace ofxLaser {
 		bool sendClear();
 		inline bool sendPointRate(uint32_t rate);
 		inline bool waitForAck(char command);
+		// reads any responses that have arrived and matches them up with
+		// the commands in flight. If block is true it waits for at least
+		// one reply
+		bool receiveResponses(bool block);
+		bool processResponse(const uint8_t* data);
+		void addPendingCommand(char command, int numpoints = 0);
+		void clearPendingCommands();
+		bool isCommandPending(char command);
+		// estimates how full the DAC's buffer is now and how many points
+		// we can send to get it up to dacBufferSize
+		void updateNumPointsToSend();
 		bool sendBytes(const uint8_t* buffer, int length);
+		// sends several buffers as a single write, used for the data
+		// header followed by the slices of the point buffer
+		bool sendBytes(const uint8_t* const* buffers, const size_t* lengths, int numbuffers);
 		
-		dac_point lastpoint;
-		dac_point sendpoint;
+		dac_point lastpoint = {}; // in wire format
 		
 		uint8_t buffer[1024];
-		uint8_t outbuffer[100000]; // TODO is this enough? is it ever checked ? 
-        int numBytesSent;
+		// only for the small commands and the header of the data command,
+		// the points are sent from bufferedPoints
+		uint8_t outbuffer[16];
 		
 		Poco::Net::StreamSocket socket;
 		
@@ -198,15 +317,23 @@ namespace ofxLaser {
 		
 		dac_response response;
 		int latencyMicros = 0;
+		int commandLatencyMicros[256] = {};
 		int prepareSendCount = 0;
-        uint64_t startTime; // to measure latency
 		bool beginSent;
 		
 		string ipaddress;
         string id; 
 		
-		deque<dac_point*> bufferedPoints;
-		vector<dac_point*> sparePoints;
+		EtherdreamPointBuffer bufferedPoints;
+		
+		deque<EtherdreamPendingCommand> pendingCommands;
+		int pointsInFlight = 0;
+		int dataCommandsInFlight = 0;
+		int estimatedBufferFullness = 0;
+		int underflowCount = 0;
+		int blankPointCount = 0;
+		// how much of a partial response is sitting in buffer
+		int receivedByteCount = 0;
 		int numPointsToSend;
 		uint32_t pps, newPPS;
 		int queuedPPSChangeMessages;
@@ -0,0 +1,379 @@
+//
+//  ofxLaserDacEtherdreamEmulator.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserDacEtherdreamEmulator.h"
+
+using namespace ofxLaser;
+
+DacEtherdreamEmulator :: ~DacEtherdreamEmulator() {
+	close();
+}
+
+bool DacEtherdreamEmulator :: setup(string ip, string broadcastip) {
+
+	try {
+		// etherdreams always talk on port 7765
+		server.bind(Poco::Net::SocketAddress(ip, 7765), true);
+		server.listen(1);
+	} catch (Poco::Exception& exc) {
+		ofLog(OF_LOG_ERROR, "DacEtherdreamEmulator setup failed - Network error: " + ip + " " + exc.displayText());
+		return false;
+	}
+
+	// and they broadcast on 7654
+	ofxUDPSettings settings;
+	settings.sendTo(broadcastip, 7654);
+	settings.broadcast = true;
+	settings.blocking = false;
+	broadcastConnection.Setup(settings);
+
+	startThread();
+	return true;
+}
+
+void DacEtherdreamEmulator :: close() {
+
+	if(isThreadRunning()) {
+		waitForThread();
+	}
+	disconnectClient();
+	server.close();
+	broadcastConnection.Close();
+}
+
+void DacEtherdreamEmulator :: setNetworkLatency(int micros, int jittermicros) {
+	if(lock()) {
+		latencyMicros = micros;
+		jitterMicros = jittermicros;
+		unlock();
+	}
+}
+
+EtherdreamEmulatorStats DacEtherdreamEmulator :: getStats() {
+	EtherdreamEmulatorStats currentstats;
+	if(lock()) {
+		currentstats = stats;
+		unlock();
+	}
+	return currentstats;
+}
+
+void DacEtherdreamEmulator :: resetStats() {
+	if(lock()) {
+		stats = EtherdreamEmulatorStats();
+		unlock();
+	}
+}
+
+string DacEtherdreamEmulator :: getId() {
+	// same as DacManagerEtherdream works it out
+	unsigned long mac = 0;
+	for(int i = 0; i<6; i++) {
+		mac<<=8;
+		mac|=macAddress[i];
+	}
+	char idchar[100];
+	sprintf(idchar, "%lX", mac);
+	return string(idchar);
+}
+
+void DacEtherdreamEmulator :: threadedFunction() {
+
+	while(isThreadRunning()) {
+
+		uint64_t now = ofGetElapsedTimeMicros();
+
+		if(now-lastBroadcastTime>1000000) {
+			sendBroadcast();
+			lastBroadcastTime = now;
+		}
+
+		if(!clientConnected) {
+			acceptClient();
+			continue;
+		}
+
+		// wait a little while for some data, but not so long that
+		// we miss sending any delayed responses
+		try {
+			bool waiting = (incoming.size()>0) || (outgoing.size()>0);
+			if(client.poll(Poco::Timespan(waiting ? 50 : 1000), Poco::Net::Socket::SELECT_READ)) {
+				int n = client.receiveBytes(receiveBuffer, sizeof(receiveBuffer));
+				if(n<=0) {
+					// the driver has closed the connection
+					disconnectClient();
+					continue;
+				}
+				now = ofGetElapsedTimeMicros();
+				TimedBytes received;
+				received.bytes.assign(receiveBuffer, receiveBuffer+n);
+				received.dueTime = getDelayedTime(now, lastIncomingDueTime);
+				incoming.push_back(received);
+			}
+		} catch (Poco::Exception& exc) {
+			ofLog(OF_LOG_ERROR, "DacEtherdreamEmulator - Network error: " + exc.displayText());
+			disconnectClient();
+			continue;
+		}
+
+		now = ofGetElapsedTimeMicros();
+		if(lock()) {
+			updatePlayback(now);
+			while((incoming.size()>0) && (incoming.front().dueTime<=now)) {
+				vector<uint8_t>& bytes = incoming.front().bytes;
+				commandBuffer.insert(commandBuffer.end(), bytes.begin(), bytes.end());
+				incoming.pop_front();
+			}
+			processCommands(now);
+			unlock();
+		}
+
+		try {
+			while((outgoing.size()>0) && (outgoing.front().dueTime<=now)) {
+				vector<uint8_t>& bytes = outgoing.front().bytes;
+				client.sendBytes(bytes.data(), bytes.size());
+				outgoing.pop_front();
+			}
+		} catch (Poco::Exception& exc) {
+			ofLog(OF_LOG_ERROR, "DacEtherdreamEmulator - Network error: " + exc.displayText());
+			disconnectClient();
+		}
+	}
+}
+
+void DacEtherdreamEmulator :: acceptClient() {
+
+	try {
+		if(!server.poll(Poco::Timespan(10000), Poco::Net::Socket::SELECT_READ)) return;
+		client = server.acceptConnection();
+		client.setNoDelay(true);
+	} catch (Poco::Exception& exc) {
+		ofLog(OF_LOG_ERROR, "DacEtherdreamEmulator - couldn't accept connection: " + exc.displayText());
+		return;
+	}
+
+	uint64_t now = ofGetElapsedTimeMicros();
+	if(lock()) {
+		clientConnected = true;
+		stats.connectionCount++;
+		// start off stopped with an empty buffer
+		playbackState = PLAYBACK_IDLE;
+		playbackFlags = 0;
+		pointsAccepted = 0;
+		playPosition = 0;
+		queuedRates.clear();
+		rateChangePoints.clear();
+		commandBuffer.clear();
+		incoming.clear();
+		outgoing.clear();
+		lastUpdateTime = now;
+		// a real etherdream sends its status as soon as you connect
+		queueResponse('a', '?', now);
+		unlock();
+	}
+}
+
+void DacEtherdreamEmulator :: disconnectClient() {
+	if(clientConnected) {
+		client.close();
+		clientConnected = false;
+	}
+}
+
+uint64_t DacEtherdreamEmulator :: getDelayedTime(uint64_t now, uint64_t& lastduetime) {
+	uint64_t due = now + latencyMicros;
+	if(jitterMicros>0) due += std::uniform_int_distribution<int>(0, jitterMicros)(jitterRandom);
+	// it's TCP so nothing can overtake anything else going the same way
+	due = MAX(due, lastduetime);
+	lastduetime = due;
+	return due;
+}
+
+int DacEtherdreamEmulator :: getBufferFullness() {
+	return pointsAccepted - (uint64_t)playPosition;
+}
+
+void DacEtherdreamEmulator :: updatePlayback(uint64_t now) {
+
+	double elapsed = (now - lastUpdateTime)/1000000.0;
+	lastUpdateTime = now;
+	if(playbackState!=PLAYBACK_PLAYING) return;
+
+	double newposition = playPosition + (elapsed*pointRate);
+
+	// any points with the rate change flag switch to the next queued rate
+	while((rateChangePoints.size()>0) && (rateChangePoints.front()<newposition)) {
+		if(queuedRates.size()>0) {
+			pointRate = queuedRates.front();
+			queuedRates.pop_front();
+		}
+		rateChangePoints.pop_front();
+	}
+
+	if(newposition>pointsAccepted) {
+		// run out of points!
+		stats.pointsPlayed += pointsAccepted - (uint64_t)playPosition;
+		playPosition = pointsAccepted;
+		playbackState = PLAYBACK_IDLE;
+		playbackFlags = 0b010;
+		stats.underflowCount++;
+	} else {
+		stats.pointsPlayed += (uint64_t)newposition - (uint64_t)playPosition;
+		playPosition = newposition;
+	}
+}
+
+void DacEtherdreamEmulator :: processCommands(uint64_t now) {
+
+	size_t pos = 0;
+	while(pos<commandBuffer.size()) {
+
+		uint8_t* data = &commandBuffer[pos];
+		size_t available = commandBuffer.size()-pos;
+		uint8_t command = data[0];
+
+		// work out how long the command is, and wait for the rest if
+		// it hasn't all arrived yet
+		size_t length = 1;
+		if(command=='b') length = 7;
+		else if(command=='q') length = 5;
+		else if(command=='d') {
+			if(available<3) break;
+			length = 3 + (DacEtherdream::bytesToUInt16(&data[1])*sizeof(dac_point));
+		}
+		if(available<length) break;
+
+		uint8_t response = 'a';
+		int fullness = getBufferFullness();
+
+		if((lightEngineState==LIGHT_ENGINE_ESTOP) && (command!='c') && (command!='?')) {
+			response = '!';
+		} else if(command=='?') {
+			// ping, just wants the status
+		} else if(command=='p') {
+			if(playbackState!=PLAYBACK_IDLE) {
+				response = 'I';
+			} else {
+				playbackState = PLAYBACK_PREPARED;
+				playbackFlags = 0;
+				pointsAccepted = 0;
+				playPosition = 0;
+				queuedRates.clear();
+				rateChangePoints.clear();
+			}
+		} else if(command=='b') {
+			if(playbackState!=PLAYBACK_PREPARED) {
+				response = 'I';
+			} else {
+				pointRate = MIN(DacEtherdream::bytesToUInt32(&data[3]), maxPointRate);
+				playbackState = PLAYBACK_PLAYING;
+				playbackFlags |= 0b001; // shutter open
+				lastUpdateTime = now;
+			}
+		} else if(command=='q') {
+			if(playbackState==PLAYBACK_IDLE) {
+				response = 'I';
+			} else if(queuedRates.size()>=16) {
+				response = 'F';
+			} else {
+				queuedRates.push_back(MIN(DacEtherdream::bytesToUInt32(&data[1]), maxPointRate));
+			}
+		} else if(command=='d') {
+			int numpoints = DacEtherdream::bytesToUInt16(&data[1]);
+			if(playbackState==PLAYBACK_IDLE) {
+				response = 'I';
+			} else if(fullness+numpoints>bufferCapacity) {
+				response = 'F';
+			} else {
+				if(playbackState==PLAYBACK_PLAYING) {
+					if((stats.lowestFullness<0) || (fullness<stats.lowestFullness)) stats.lowestFullness = fullness;
+				}
+				// look for the rate change flag, bit 15 of the control
+				const uint8_t* pointdata = &data[3];
+				for(int i = 0; i<numpoints; i++) {
+					if(pointdata[(i*sizeof(dac_point))+1] & 0x80) {
+						rateChangePoints.push_back(pointsAccepted+i);
+					}
+				}
+				pointsAccepted+=numpoints;
+				stats.pointsReceived+=numpoints;
+				stats.dataCommandCount++;
+			}
+		} else if(command=='s') {
+			if(playbackState==PLAYBACK_IDLE) {
+				response = 'I';
+			} else {
+				playbackState = PLAYBACK_IDLE;
+				playbackFlags &= ~0b001;
+			}
+		} else if(command=='c') {
+			lightEngineState = LIGHT_ENGINE_READY;
+			lightEngineFlags = 0;
+			playbackFlags &= ~0b100;
+		} else {
+			// 0x00 and 0xff are emergency stops, anything else we don't
+			// understand is too
+			lightEngineState = LIGHT_ENGINE_ESTOP;
+			lightEngineFlags |= 0b00001;
+			playbackState = PLAYBACK_IDLE;
+			playbackFlags |= 0b100;
+			if((command!=0x00) && (command!=0xff)) response = 'I';
+		}
+
+		stats.commandCount++;
+		if(response!='a') stats.nakCount++;
+		queueResponse(response, command, now);
+		pos+=length;
+	}
+	commandBuffer.erase(commandBuffer.begin(), commandBuffer.begin()+pos);
+}
+
+void DacEtherdreamEmulator :: queueResponse(uint8_t response, uint8_t command, uint64_t now) {
+	TimedBytes reply;
+	reply.bytes.resize(22);
+	reply.bytes[0] = response;
+	reply.bytes[1] = command;
+	writeStatus(&reply.bytes[2]);
+	reply.dueTime = getDelayedTime(now, lastOutgoingDueTime);
+	outgoing.push_back(reply);
+}
+
+void DacEtherdreamEmulator :: writeStatus(uint8_t* data) {
+	// 20 bytes, in the same order as dac_status
+	uint16_t fullness = getBufferFullness();
+	uint16_t sourceflags = 0;
+	uint32_t pointcount = (uint32_t)playPosition;
+	data[0] = 0; // protocol
+	data[1] = lightEngineState;
+	data[2] = playbackState;
+	data[3] = 0; // source, 0 is network streaming
+	DacEtherdream::writeUInt16ToBytes(lightEngineFlags, &data[4]);
+	DacEtherdream::writeUInt16ToBytes(playbackFlags, &data[6]);
+	DacEtherdream::writeUInt16ToBytes(sourceflags, &data[8]);
+	DacEtherdream::writeUInt16ToBytes(fullness, &data[10]);
+	DacEtherdream::writeUInt32ToBytes(pointRate, &data[12]);
+	DacEtherdream::writeUInt32ToBytes(pointcount, &data[16]);
+}
+
+void DacEtherdreamEmulator :: sendBroadcast() {
+
+	// mac address, hardware revision, software revision, buffer
+	// capacity, max point rate and then the status
+	uint8_t packet[36];
+	uint16_t hardwarerevision = 0;
+	uint16_t softwarerevision = 2;
+	uint16_t capacity = bufferCapacity;
+	memcpy(packet, macAddress, 6);
+	DacEtherdream::writeUInt16ToBytes(hardwarerevision, &packet[6]);
+	DacEtherdream::writeUInt16ToBytes(softwarerevision, &packet[8]);
+	DacEtherdream::writeUInt16ToBytes(capacity, &packet[10]);
+	DacEtherdream::writeUInt32ToBytes(maxPointRate, &packet[12]);
+	if(lock()) {
+		writeStatus(&packet[16]);
+		unlock();
+	}
+	broadcastConnection.Send((const char*)packet, sizeof(packet));
+}
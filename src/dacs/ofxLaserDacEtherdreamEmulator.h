@@ -0,0 +1,121 @@
+//
+//  ofxLaserDacEtherdreamEmulator.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+#include "ofxNetwork.h"
+#include "ofxLaserDacEtherdream.h"
+
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/NetException.h"
+
+namespace ofxLaser {
+
+struct EtherdreamEmulatorStats {
+	uint64_t pointsReceived = 0;
+	uint64_t pointsPlayed = 0;
+	int underflowCount = 0;
+	int commandCount = 0;
+	int dataCommandCount = 0;
+	int nakCount = 0;
+	int connectionCount = 0;
+	// the lowest the buffer got while it was playing, -1 if it hasn't played
+	int lowestFullness = -1;
+};
+
+// A pretend Etherdream that runs on this computer, so that we can test and
+// benchmark DacEtherdream without any hardware. It sends out the same
+// broadcast packets as a real one (so DacManagerEtherdream finds it) and
+// accepts a connection on port 7765. It understands the ?, p, b, d, q, s
+// and c commands, and the buffer empties at the point rate so it will
+// underflow if the points don't arrive in time, just like a real one.
+//
+// You can also add some network latency (in each direction) to see how
+// the driver copes with a slow network.
+class DacEtherdreamEmulator : public ofThread {
+
+	public :
+
+	~DacEtherdreamEmulator();
+
+	// starts listening for the driver and broadcasting. Only one real
+	// or pretend etherdream can use each ip address
+	bool setup(string ip = "127.0.0.1", string broadcastip = "127.0.0.1");
+	void close();
+
+	void setNetworkLatency(int micros, int jittermicros = 0);
+
+	EtherdreamEmulatorStats getStats();
+	void resetStats();
+	bool isClientConnected() { return clientConnected; }
+	// the id that DacManagerEtherdream will give it
+	string getId();
+
+	int bufferCapacity = 1799;
+	uint32_t maxPointRate = 100000;
+	uint8_t macAddress[6] = {0x00, 0x04, 0xa3, 0xed, 0xed, 0x01};
+
+	protected :
+
+	void threadedFunction() override;
+
+	void acceptClient();
+	void disconnectClient();
+	// plays the points that would have been played since the last update
+	void updatePlayback(uint64_t now);
+	void processCommands(uint64_t now);
+	void queueResponse(uint8_t response, uint8_t command, uint64_t now);
+	void writeStatus(uint8_t* data);
+	void sendBroadcast();
+	// lastduetime is the due time of the last bytes going the same way
+	uint64_t getDelayedTime(uint64_t now, uint64_t& lastduetime);
+	int getBufferFullness();
+
+	Poco::Net::ServerSocket server;
+	Poco::Net::StreamSocket client;
+	bool clientConnected = false;
+	ofxUDPManager broadcastConnection;
+	uint64_t lastBroadcastTime = 0;
+
+	// bytes on their way in or out, for the pretend latency
+	struct TimedBytes {
+		vector<uint8_t> bytes;
+		uint64_t dueTime;
+	};
+	deque<TimedBytes> incoming;
+	deque<TimedBytes> outgoing;
+	// each direction is its own stream so they're kept in order separately
+	uint64_t lastIncomingDueTime = 0;
+	uint64_t lastOutgoingDueTime = 0;
+	int latencyMicros = 0;
+	int jitterMicros = 0;
+	// ofRandom isn't safe to use from this thread. Always the same seed so
+	// the benchmarks can be repeated
+	std::mt19937 jitterRandom{1};
+
+	// commands that have arrived but we haven't got all of yet
+	vector<uint8_t> commandBuffer;
+	uint8_t receiveBuffer[65536];
+
+	// the state of the pretend DAC
+	uint8_t lightEngineState = LIGHT_ENGINE_READY;
+	uint8_t playbackState = PLAYBACK_IDLE;
+	uint16_t lightEngineFlags = 0;
+	uint16_t playbackFlags = 0;
+	uint32_t pointRate = 0;
+	// total points since the last prepare, and how far through them we are
+	uint64_t pointsAccepted = 0;
+	double playPosition = 0;
+	uint64_t lastUpdateTime = 0;
+	// rate changes from 'q' commands, and the points that trigger them
+	deque<uint32_t> queuedRates;
+	deque<uint64_t> rateChangePoints;
+
+	EtherdreamEmulatorStats stats;
+
+};
+}
@@ -0,0 +1,97 @@
+//
+//  ofxLaserDacEtherdreamLatencyControl.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserDacEtherdreamLatencyControl.h"
+
+using namespace ofxLaser;
+
+void EtherdreamLatencyControl :: reset() {
+	smoothedRoundTrip = 0;
+	roundTripVariation = 0;
+	hasRoundTrip = false;
+	headroom = 2;
+	lowestFullness = -1;
+	lastAdjustmentTime = 0;
+	underflowed = false;
+	underflowTimes.clear();
+	targetMicros = 40000;
+}
+
+void EtherdreamLatencyControl :: addRoundTrip(int micros) {
+
+	if(micros<0) return;
+	if(!hasRoundTrip) {
+		smoothedRoundTrip = micros;
+		roundTripVariation = micros/2;
+		hasRoundTrip = true;
+	} else {
+		// same weightings as TCP uses for its retransmit timer
+		roundTripVariation += (fabs(smoothedRoundTrip-micros) - roundTripVariation)*0.25f;
+		smoothedRoundTrip += (micros - smoothedRoundTrip)*0.125f;
+	}
+}
+
+void EtherdreamLatencyControl :: addBufferFullness(int fullness) {
+	if(fullness<0) fullness = 0;
+	if((lowestFullness<0) || (fullness<lowestFullness)) lowestFullness = fullness;
+}
+
+void EtherdreamLatencyControl :: addUnderflow(uint64_t nowMicros) {
+	underflowTimes.push_back(nowMicros);
+	// the update deals with it
+	underflowed = true;
+}
+
+float EtherdreamLatencyControl :: getUnderflowsPerMinute(uint64_t nowMicros) {
+	while((underflowTimes.size()>0) && (nowMicros-underflowTimes.front()>60000000)) {
+		underflowTimes.pop_front();
+	}
+	return underflowTimes.size();
+}
+
+int EtherdreamLatencyControl :: update(uint32_t pointRate, int packetPoints, uint64_t nowMicros) {
+
+	if(pointRate==0) return targetPoints;
+	if(lastAdjustmentTime==0) lastAdjustmentTime = nowMicros;
+
+	safetyMarginMicros = MAX(smoothedRoundTrip + (roundTripVariation*4), minSafetyMarginMicros)*headroom;
+
+	if(underflowed) {
+		// back off straight away
+		headroom = MIN(headroom*1.5f, maxHeadroom);
+		targetMicros *= 1.5f;
+		underflowed = false;
+		lowestFullness = -1;
+		lastAdjustmentTime = nowMicros;
+
+	} else if(nowMicros-lastAdjustmentTime>1000000) {
+		// once a second, see how close we got to running out
+
+		if(getUnderflowsPerMinute(nowMicros)>maxUnderflowsPerMinute) {
+			headroom = MIN(headroom*1.1f, maxHeadroom);
+		} else {
+			headroom = MAX(headroom*0.95f, minHeadroom);
+		}
+
+		if(lowestFullness>=0) {
+			float lowestMicros = (float)lowestFullness*1000000/pointRate;
+			float spare = lowestMicros - safetyMarginMicros;
+			// come down gently but go up quickly
+			if(spare>0) targetMicros -= spare*0.5f;
+			else targetMicros -= spare;
+		}
+		lowestFullness = -1;
+		lastAdjustmentTime = nowMicros;
+	}
+
+	// has to be enough room to send a packet at least
+	int minpoints = MAX(minTargetPoints, packetPoints*2);
+	targetPoints = (float)targetMicros*pointRate/1000000;
+	targetPoints = MAX(MIN(targetPoints, maxTargetPoints), minpoints);
+	targetMicros = (float)targetPoints*1000000/pointRate;
+
+	return targetPoints;
+}
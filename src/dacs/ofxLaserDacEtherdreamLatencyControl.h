@@ -0,0 +1,78 @@
+//
+//  ofxLaserDacEtherdreamLatencyControl.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+
+namespace ofxLaser {
+
+// Works out how full to keep the Etherdream's buffer. The fuller it is,
+// the longer it takes for points to come out of the laser, but if it's
+// too empty then a slow network reply (or a busy computer) means it runs
+// out of points and stops (an underflow).
+//
+// It watches how low the buffer gets just before each top up. Once a
+// second it moves the target so that the lowest point is a safety margin
+// above empty, where the margin is based on how much the round trip time
+// varies, times a headroom factor. An underflow bumps the target and the
+// headroom up straight away, and the headroom slowly comes back down
+// while the underflows are under maxUnderflowsPerMinute.
+class EtherdreamLatencyControl {
+
+	public :
+
+	void reset();
+
+	// every time we get an ack
+	void addRoundTrip(int micros);
+	// how full the buffer was just before we topped it up
+	void addBufferFullness(int fullness);
+	void addUnderflow(uint64_t nowMicros);
+
+	// recalculates the target, returns the number of points to keep in
+	// the buffer. packetPoints is the smallest amount we send at once
+	int update(uint32_t pointRate, int packetPoints, uint64_t nowMicros);
+
+	int getTargetPoints() const { return targetPoints; }
+	int getTargetMicros() const { return targetMicros; }
+	int getRoundTripMicros() const { return smoothedRoundTrip; }
+	int getJitterMicros() const { return roundTripVariation; }
+	int getSafetyMarginMicros() const { return safetyMarginMicros; }
+	float getHeadroom() const { return headroom; }
+	float getUnderflowsPerMinute(uint64_t nowMicros);
+
+	// settings
+	float maxUnderflowsPerMinute = 1;
+	int minTargetPoints = 200;
+	// the etherdream v1 buffer holds 1799 points
+	int maxTargetPoints = 1799;
+	// the margin is never less than this
+	int minSafetyMarginMicros = 2000;
+
+	protected :
+
+	float smoothedRoundTrip = 0;
+	float roundTripVariation = 0;
+	bool hasRoundTrip = false;
+
+	float headroom = 2;
+	float minHeadroom = 1;
+	float maxHeadroom = 20;
+
+	// the lowest the buffer got since the last adjustment
+	int lowestFullness = -1;
+	uint64_t lastAdjustmentTime = 0;
+	bool underflowed = false;
+
+	deque<uint64_t> underflowTimes;
+
+	// start off with the old default of 1200 points at 30k
+	float targetMicros = 40000;
+	int targetPoints = 1200;
+	int safetyMarginMicros = 0;
+
+};
+}
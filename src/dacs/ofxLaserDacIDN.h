@@ -9,39 +9,13 @@
 #pragma once
 #include "ofMain.h"
 #include "ofxLaserDacBase.h"
-#include "ofxNetwork.h"
+#include "ofxLaserDacIDNPacketSender.h"
 
 #define IDN_MIN -32768
 #define IDN_MAX 32767
 
 namespace ofxLaser {
 	
-class IDN_point {
-	public :
-	
-	char* getSerialised() {
-		
-		serialized[0] = (uint8_t) (x >> 8);
-		serialized[1] = (uint8_t) (x);
-		serialized[2] = (uint8_t) (y >> 8);
-		serialized[3] = (uint8_t) (y);
-		serialized[4] = r;
-		serialized[5] = g;
-		serialized[6] = b;
-		
-		return (char*) &serialized;
-	}
-	
-	char serialized[7];
-	
-	uint16_t x;
-	uint16_t y;
-	uint8_t r;
-	uint8_t g;
-	uint8_t b;
-};
-
-	
 class DacIDN : public DacBase, ofThread {
 	
 	public:
@@ -62,15 +36,17 @@ class DacIDN : public DacBase, ofThread {
 	
 	void close() override ;
 	
+	// the biggest packet the network can carry, 1500 unless your network
+	// is set up for jumbo frames. Set it before calling setup
+	int mtu = 1500;
+	
 	protected:
 
 	private:
 
 	void threadedFunction() override;
 	
-	void sendFrameToDac();
-
-	ofxUDPManager udpConnection;
+	IDNPacketSender packetSender;
 
 	uint32_t pps;
 	bool connected;
@@ -78,11 +54,9 @@ class DacIDN : public DacBase, ofThread {
 	uint64_t lastFrameTime;
 	uint64_t lastFrameDuration;
 	
+	// filled under lock, then swapped with bufferedPoints by the thread
 	vector<IDN_point> pointsToSend;
-	deque<IDN_point> bufferedPoints;
-	uint16_t counter ;
-
-	const bool verbose = false; 
+	vector<IDN_point> bufferedPoints;
 
 };
 
@@ -0,0 +1,198 @@
+//
+//  ofxLaserDacIDNPacketSender.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserDacIDNPacketSender.h"
+
+using namespace ofxLaser;
+
+// the IP and UDP headers
+#define IDN_UDP_OVERHEAD 28
+// the biggest UDP payload there can be
+#define IDN_MAX_PACKET_SIZE 65507
+// the packet header, channel message header and timestamp
+#define IDN_HEADER_SIZE 12
+// the first packet of the frame also has the channel config and the data
+// header
+#define IDN_FIRST_HEADER_SIZE 36
+#define IDN_POINT_SIZE 7
+
+static inline void writeUInt16BE(uint8_t* dest, uint16_t n) {
+	dest[0] = (uint8_t)(n>>8);
+	dest[1] = (uint8_t)n;
+}
+
+bool IDNPacketSender :: setup(string ip, int port) {
+
+	setMtu(mtu);
+	try {
+		socket.connect(Poco::Net::SocketAddress(ip, port));
+		connected = true;
+	} catch (Poco::Exception& exc) {
+		ofLog(OF_LOG_ERROR, "IDNPacketSender setup failed - Network error: " + ip + " " + exc.displayText());
+		connected = false;
+	}
+	return connected;
+}
+
+void IDNPacketSender :: close() {
+	if(connected) socket.close();
+	connected = false;
+}
+
+void IDNPacketSender :: setMtu(int newmtu) {
+	// there has to be room for the headers and at least one point
+	mtu = MAX(newmtu, IDN_UDP_OVERHEAD + IDN_FIRST_HEADER_SIZE + IDN_POINT_SIZE);
+	maxPacketSize = MIN(mtu - IDN_UDP_OVERHEAD, IDN_MAX_PACKET_SIZE);
+}
+
+int IDNPacketSender :: buildPackets(const IDN_point* points, size_t numpoints, uint32_t pps) {
+
+	packetSizes.clear();
+	if((numpoints==0) || (pps==0)) return 0;
+
+	int pointsInFirst = (maxPacketSize - IDN_FIRST_HEADER_SIZE)/IDN_POINT_SIZE;
+	int pointsInOthers = (maxPacketSize - IDN_HEADER_SIZE)/IDN_POINT_SIZE;
+	int numfragments = 1;
+	if((int)numpoints>pointsInFirst) {
+		numfragments += (numpoints - pointsInFirst + pointsInOthers - 1)/pointsInOthers;
+	}
+
+	// only ever grows
+	size_t buffersize = (size_t)numfragments*maxPacketSize;
+	if(packetBuffer.size()<buffersize) packetBuffer.resize(buffersize);
+
+	uint32_t timestamp = ofGetElapsedTimeMicros();
+	// the frame duration is what sets the point speed
+	int framemicros = (((uint64_t)(numpoints - 1)) * 1000000ull) / (uint64_t)pps;
+
+	size_t pointindex = 0;
+	for(int i = 0; i<numfragments; i++) {
+
+		uint8_t* packet = &packetBuffer[(size_t)i*maxPacketSize];
+		int pos = writeHeader(packet, i, numfragments, timestamp+i, framemicros);
+
+		// XXYYRGB
+		size_t lastpoint = MIN(pointindex + ((i==0) ? pointsInFirst : pointsInOthers), numpoints);
+		for(; pointindex<lastpoint; pointindex++) {
+			points[pointindex].write(&packet[pos]);
+			pos+=IDN_POINT_SIZE;
+		}
+
+		// the size doesn't include the first four bytes
+		writeUInt16BE(&packet[4], pos-4);
+		packetSizes.push_back(pos);
+	}
+
+	return numfragments;
+}
+
+int IDNPacketSender :: writeHeader(uint8_t* packet, int fragment, int numfragments, uint32_t timestamp, int framemicros) {
+
+	bool sendConfig = (fragment==0);
+
+	packet[0] = 0x40;
+	packet[1] = 0x00;
+	writeUInt16BE(&packet[2], counter++);
+
+	// packet[4] and [5] are the size, filled in at the end
+
+	// CNL with configuration bit set (0x80 | 0x40) = 0xC0;
+	// also set with last fragment. Weird.
+	packet[6] = (sendConfig || (fragment==numfragments-1)) ? 0xc0 : 0x80;
+
+	// CHUNK TYPE
+	// 0x02 - Frame samples entire frame
+	// 0x03 - Frame samples first fragment
+	// 0xC0 - Frame samples sequel fragment
+	if(numfragments==1) packet[7] = 0x02;
+	else if(fragment==0) packet[7] = 0x03;
+	else packet[7] = 0xc0;
+
+	// TIME STAMP
+	packet[8] = (uint8_t)(timestamp >> 24);
+	packet[9] = (uint8_t)(timestamp >> 16);
+	packet[10] = (uint8_t)(timestamp >> 8);
+	packet[11] = (uint8_t)(timestamp);
+
+	if(!sendConfig) return IDN_HEADER_SIZE;
+
+	static const uint8_t config[] = {
+		// NUMBER OF CONFIG WORDS, SET ROUTING FLAG, ID (always 0), DISCRETE GRAPHICS MODE
+		0x04, 0x01, 0x00, 0x02,
+		// CONF 1 X, 16 BIT PRECISION
+		0x42, 0x00, 0x40, 0x10,
+		// CONF 2 Y, 16 BIT PRECISION
+		0x42, 0x10, 0x40, 0x10,
+		// CONF 3 RED 638nm, CONF 4 GREEN 532nm
+		0x52, 0x7e, 0x52, 0x14,
+		// CONF 5 BLUE, Conf 6... blank zeros???
+		0x51, 0xcc, 0x00, 0x00
+	};
+	memcpy(&packet[IDN_HEADER_SIZE], config, sizeof(config));
+	int pos = IDN_HEADER_SIZE + sizeof(config);
+
+	// Data header
+	// Flags - if bit 1 is set then frame is played once, otherwise it repeats
+	packet[pos++] = 0x01;
+	// Then it's the frame duration in microseconds
+	packet[pos++] = (uint8_t)(framemicros >> 16);
+	packet[pos++] = (uint8_t)(framemicros >> 8);
+	packet[pos++] = (uint8_t)(framemicros);
+
+	return pos;
+}
+
+bool IDNPacketSender :: sendPackets() {
+
+	if(!connected) return false;
+	int numpackets = packetSizes.size();
+
+#ifdef __linux__
+	if(batchSend) {
+		messages.resize(numpackets);
+		messageData.resize(numpackets);
+		for(int i = 0; i<numpackets; i++) {
+			messageData[i].iov_base = &packetBuffer[(size_t)i*maxPacketSize];
+			messageData[i].iov_len = packetSizes[i];
+			memset(&messages[i], 0, sizeof(struct mmsghdr));
+			messages[i].msg_hdr.msg_iov = &messageData[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+		}
+		// the socket is connected so there's no need for an address
+		int sent = 0;
+		int fd = socket.impl()->sockfd();
+		while(sent<numpackets) {
+			int n = ::sendmmsg(fd, &messages[sent], numpackets-sent, 0);
+			if(n<0) {
+				if(errno==EINTR) continue;
+				ofLog(OF_LOG_ERROR, "IDNPacketSender - send failed : " + ofToString(strerror(errno)));
+				return false;
+			}
+			for(int i = sent; i<sent+n; i++) bytesSent+=packetSizes[i];
+			sent+=n;
+			packetsSent+=n;
+		}
+		return true;
+	}
+#endif
+
+	try {
+		for(int i = 0; i<numpackets; i++) {
+			socket.sendBytes(&packetBuffer[(size_t)i*maxPacketSize], packetSizes[i]);
+			bytesSent+=packetSizes[i];
+			packetsSent++;
+		}
+	} catch (Poco::Exception& exc) {
+		ofLog(OF_LOG_ERROR, "IDNPacketSender - send failed : " + exc.displayText());
+		return false;
+	}
+	return true;
+}
+
+bool IDNPacketSender :: sendFrame(const IDN_point* points, size_t numpoints, uint32_t pps) {
+	buildPackets(points, numpoints, pps);
+	return sendPackets();
+}
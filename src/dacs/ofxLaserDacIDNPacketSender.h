@@ -0,0 +1,100 @@
+//
+//  ofxLaserDacIDNPacketSender.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofMain.h"
+
+#include "Poco/Net/DatagramSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/NetException.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace ofxLaser {
+
+class IDN_point {
+	public :
+
+	// 7 bytes, XXYYRGB, big endian
+	inline void write(uint8_t* dest) const {
+		dest[0] = (uint8_t) (x >> 8);
+		dest[1] = (uint8_t) (x);
+		dest[2] = (uint8_t) (y >> 8);
+		dest[3] = (uint8_t) (y);
+		dest[4] = r;
+		dest[5] = g;
+		dest[6] = b;
+	}
+
+	uint16_t x;
+	uint16_t y;
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+};
+
+// Turns a frame of points into IDN-Stream packets and sends them over UDP.
+// The packets are built straight into one buffer that gets reused, and
+// they're split up so that each one fits into a single ethernet packet
+// (set by the MTU) rather than relying on IP fragmentation. On linux all
+// of the packets for a frame go out in a single sendmmsg call.
+class IDNPacketSender {
+
+	public :
+
+	bool setup(string ip, int port = 7255);
+	void close();
+
+	// the biggest IP packet that the network can carry without splitting
+	// it up. 1500 for normal ethernet, up to 9000 with jumbo frames
+	void setMtu(int newmtu);
+	int getMtu() { return mtu; }
+
+	// builds the packets and sends them, returns false if any failed
+	bool sendFrame(const IDN_point* points, size_t numpoints, uint32_t pps);
+
+	// the two halves of sendFrame, separately so they can be timed
+	int buildPackets(const IDN_point* points, size_t numpoints, uint32_t pps);
+	bool sendPackets();
+
+	int getNumPackets() { return (int)packetSizes.size(); }
+	uint64_t getBytesSent() { return bytesSent; }
+	uint64_t getPacketsSent() { return packetsSent; }
+
+	// turn off to send the packets one at a time, even on linux
+	bool batchSend = true;
+
+	protected :
+
+	int writeHeader(uint8_t* packet, int fragment, int numfragments, uint32_t timestamp, int framemicros);
+
+	Poco::Net::DatagramSocket socket;
+	bool connected = false;
+
+	int mtu = 1500;
+	// the most bytes we can put in a UDP packet
+	int maxPacketSize;
+
+	// all of the packets for a frame, each one starts at a multiple of
+	// maxPacketSize
+	vector<uint8_t> packetBuffer;
+	vector<int> packetSizes;
+
+#ifdef __linux__
+	vector<struct mmsghdr> messages;
+	vector<struct iovec> messageData;
+#endif
+
+	uint16_t counter = 0;
+	uint64_t bytesSent = 0;
+	uint64_t packetsSent = 0;
+
+};
+
+}
@@ -18,25 +18,206 @@ void Warper::updateHomography(glm::vec3 src1, glm::vec3 src2, glm::vec3 src3, gl
 	// the source points are the zone points in screen space
 	// the dest points are points in the output space
 	
-	srcCVPoints.resize(4);
-	dstCVPoints.resize(4);
-	srcCVPoints[0] = toCv(src1);
-	srcCVPoints[1] = toCv(src2);
-	srcCVPoints[2] = toCv(src3);
-	srcCVPoints[3] = toCv(src4);
-	dstCVPoints[0] = toCv(dst1);
-	dstCVPoints[1] = toCv(dst2);
-	dstCVPoints[2] = toCv(dst3);
-	dstCVPoints[3] = toCv(dst4);
-
+	// with exactly four points there's only one homography that fits so
+	// rather than use cv::findHomography we get the mapping from the unit
+	// square to each quad and combine them. NB the corners go round the
+	// square so the bottom two are swapped.
+	glm::vec2 srcquad[4] = {glm::vec2(src1), glm::vec2(src2), glm::vec2(src4), glm::vec2(src3)};
+	glm::vec2 dstquad[4] = {glm::vec2(dst1), glm::vec2(dst2), glm::vec2(dst4), glm::vec2(dst3)};
+	
+	double squaretosrc[9], squaretodst[9], srctosquare[9];
+	double matrix[9], inverse[9];
+	
+	if(getSquareToQuadMatrix(srcquad, squaretosrc) &&
+	   getSquareToQuadMatrix(dstquad, squaretodst) &&
+	   invertMatrix(squaretosrc, srctosquare)) {
+		
+		multiplyMatrices(squaretodst, srctosquare, matrix);
+		if(invertMatrix(matrix, inverse)) {
+			setMatrices(matrix, inverse);
+		} else {
+			ofLogWarning("Warper::updateHomography") << "homography can't be inverted, keeping last one";
+		}
+	} else {
+		ofLogWarning("Warper::updateHomography") << "degenerate quad, keeping last homography";
+	}
+	
+	updateBilinear(src1, src4, dst1, dst2, dst3, dst4);
+	
+}
 
+bool Warper::updateHomography(const vector<glm::vec3>& srcpoints, const vector<glm::vec3>& dstpoints) {
+	
+	if((srcpoints.size()!=dstpoints.size()) || (srcpoints.size()<4)) {
+		ofLogError("Warper::updateHomography") << "needs at least four pairs of points";
+		return false;
+	}
+	if(srcpoints.size()==4) {
+		updateHomography(srcpoints[0], srcpoints[1], srcpoints[2], srcpoints[3], dstpoints[0], dstpoints[1], dstpoints[2], dstpoints[3]);
+		return true;
+	}
+	
+	srcCVPoints.resize(srcpoints.size());
+	dstCVPoints.resize(dstpoints.size());
+	for(size_t i = 0; i<srcpoints.size(); i++) {
+		srcCVPoints[i] = toCv(srcpoints[i]);
+		dstCVPoints[i] = toCv(dstpoints[i]);
+	}
+	
+	bool success = false;
 	try{
 		// NB 8 is CV_RANSAC which isn't defined in all platforms for some reason.
-		homography = cv::findHomography(cv::Mat(srcCVPoints), cv::Mat(dstCVPoints),8, 100);
-		inverseHomography = homography.inv();
+		cv::Mat homography = cv::findHomography(cv::Mat(srcCVPoints), cv::Mat(dstCVPoints),8, 100);
+		// findHomography returns an empty matrix if it fails
+		if((homography.rows==3) && (homography.cols==3)) {
+			cv::Mat h;
+			homography.convertTo(h, CV_64F);
+			double matrix[9], inverse[9];
+			for(int i = 0; i<9; i++) matrix[i] = h.at<double>(i/3, i%3);
+			if(invertMatrix(matrix, inverse)) {
+				setMatrices(matrix, inverse);
+				success = true;
+			}
+		}
 	} catch ( cv::Exception & e ) {
 		ofLog(OF_LOG_ERROR, e.msg ); // output exception message
 	}
+	
+	updateBilinear(srcpoints[0], srcpoints[3], dstpoints[0], dstpoints[1], dstpoints[2], dstpoints[3]);
+	return success;
+}
+
+bool Warper::getSquareToQuadMatrix(const glm::vec2* quad, double* m) {
+	
+	// Paul Heckbert's closed form solution, from "Fundamentals of Texture
+	// Mapping and Image Warping"
+	double x0 = quad[0].x, y0 = quad[0].y;
+	double x1 = quad[1].x, y1 = quad[1].y;
+	double x2 = quad[2].x, y2 = quad[2].y;
+	double x3 = quad[3].x, y3 = quad[3].y;
+	
+	double sx = x0 - x1 + x2 - x3;
+	double sy = y0 - y1 + y2 - y3;
+	
+	double g, h;
+	if((sx==0) && (sy==0)) {
+		// it's a parallelogram so the mapping is affine
+		g = 0;
+		h = 0;
+	} else {
+		double dx1 = x1 - x2;
+		double dx2 = x3 - x2;
+		double dy1 = y1 - y2;
+		double dy2 = y3 - y2;
+		double denominator = (dx1*dy2) - (dx2*dy1);
+		if(fabs(denominator)<1e-12) return false;
+		g = ((sx*dy2) - (dx2*sy)) / denominator;
+		h = ((dx1*sy) - (sx*dy1)) / denominator;
+	}
+	
+	m[0] = x1 - x0 + (g*x1);
+	m[1] = x3 - x0 + (h*x3);
+	m[2] = x0;
+	m[3] = y1 - y0 + (g*y1);
+	m[4] = y3 - y0 + (h*y3);
+	m[5] = y0;
+	m[6] = g;
+	m[7] = h;
+	m[8] = 1;
+	return true;
+}
+
+bool Warper::invertMatrix(const double* m, double* inverse) {
+	
+	// adjugate divided by the determinant
+	double a = (m[4]*m[8]) - (m[5]*m[7]);
+	double b = (m[5]*m[6]) - (m[3]*m[8]);
+	double c = (m[3]*m[7]) - (m[4]*m[6]);
+	double determinant = (m[0]*a) + (m[1]*b) + (m[2]*c);
+	
+	if((determinant==0) || !std::isfinite(determinant)) return false;
+	
+	double scale = 1.0/determinant;
+	inverse[0] = a*scale;
+	inverse[1] = ((m[2]*m[7]) - (m[1]*m[8]))*scale;
+	inverse[2] = ((m[1]*m[5]) - (m[2]*m[4]))*scale;
+	inverse[3] = b*scale;
+	inverse[4] = ((m[0]*m[8]) - (m[2]*m[6]))*scale;
+	inverse[5] = ((m[2]*m[3]) - (m[0]*m[5]))*scale;
+	inverse[6] = c*scale;
+	inverse[7] = ((m[1]*m[6]) - (m[0]*m[7]))*scale;
+	inverse[8] = ((m[0]*m[4]) - (m[1]*m[3]))*scale;
+	return true;
+}
+
+void Warper::multiplyMatrices(const double* a, const double* b, double* result) {
+	for(int row = 0; row<3; row++) {
+		for(int col = 0; col<3; col++) {
+			result[(row*3)+col] = (a[row*3]*b[col]) + (a[(row*3)+1]*b[3+col]) + (a[(row*3)+2]*b[6+col]);
+		}
+	}
+}
+
+void Warper::setMatrices(const double* matrix, const double* inverse) {
+	
+	// normalise so the bottom right is 1, same as findHomography
+	double scale = (fabs(matrix[8])>1e-12) ? 1.0/matrix[8] : 1;
+	double inversescale = (fabs(inverse[8])>1e-12) ? 1.0/inverse[8] : 1;
+	for(int i = 0; i<9; i++) {
+		homographyMatrix[i] = matrix[i]*scale;
+		inverseHomographyMatrix[i] = inverse[i]*inversescale;
+	}
+}
+
+void Warper::updateBilinear(glm::vec3 src1, glm::vec3 src4, glm::vec3 dst1, glm::vec3 dst2, glm::vec3 dst3, glm::vec3 dst4) {
+	
+	glm::vec3 d = src4 - src1;
+	glm::vec3& A = dst1;
+	glm::vec3& B = dst2;
+	glm::vec3& C = dst4;
+	glm::vec3& D = dst3;
+	bilinearOrigin = glm::vec2(src1.x, src1.y);
+	bilinearScale = glm::vec2(1.0f/d.x, 1.0f/d.y);
+	bilinearA = glm::vec2(A.x, A.y);
+	bilinearU = glm::vec2(B.x-A.x, B.y-A.y);
+	bilinearV = glm::vec2(D.x-A.x, D.y-A.y);
+	bilinearUV = glm::vec2(A.x-B.x+C.x-D.x, A.y-B.y+C.y-D.y);
+	
+}
+
+cv::Mat Warper::getHomography() {
+	cv::Mat m(3, 3, CV_64F);
+	for(int i = 0; i<9; i++) m.at<double>(i/3, i%3) = homographyMatrix[i];
+	return m;
+}
+
+cv::Mat Warper::getInverseHomography() {
+	cv::Mat m(3, 3, CV_64F);
+	for(int i = 0; i<9; i++) m.at<double>(i/3, i%3) = inverseHomographyMatrix[i];
+	return m;
+}
+
+void Warper::getWarpedPoints(Point* points, size_t count, bool useHomography) {
+	
+	if(useHomography) {
+		const float* m = homographyMatrix;
+		for(size_t i = 0; i<count; i++) {
+			Point& p = points[i];
+			float x, y;
+			transformPoint(m, p.x, p.y, x, y);
+			p.x = x;
+			p.y = y;
+		}
+	} else {
+		for(size_t i = 0; i<count; i++) {
+			Point& p = points[i];
+			float u = (p.x-bilinearOrigin.x)*bilinearScale.x;
+			float v = (p.y-bilinearOrigin.y)*bilinearScale.y;
+			float uv = u*v;
+			p.x = bilinearA.x + (bilinearU.x*u) + (bilinearV.x*v) + (bilinearUV.x*uv);
+			p.y = bilinearA.y + (bilinearU.y*u) + (bilinearV.y*v) + (bilinearUV.y*uv);
+		}
+	}
 }
 
 
@@ -65,16 +246,9 @@ cv::Point2f Warper :: getWarpedPoint(float x, float y, bool useHomography) {
 
 
 	if(useHomography) {
-		if (post.size() < 1) post.resize(1);
-		if (pre.size() < 1) pre.resize(1);
-		pre[0].x = x;
-		pre[0].y = y;
-		try {
-			cv::perspectiveTransform(pre, post, homography);
-		} catch ( cv::Exception & e ) {
-			ofLog(OF_LOG_ERROR, e.msg ); // output exception message
-		}
-		return post[0];
+		cv::Point2f result;
+		transformPoint(homographyMatrix, x, y, result.x, result.y);
+		return result;
 	} else {
 
 
@@ -87,15 +261,12 @@ cv::Point2f Warper :: getWarpedPoint(float x, float y, bool useHomography) {
 //		X(u,v) = A + (B-A)·u + (D-A)·v + (A-B+C-D)·u·v
 
 
-		cv::Point2f d = srcCVPoints[3] - srcCVPoints[0];
-		float u = (x-(srcCVPoints[0].x))/d.x;
-		float v = (y-(srcCVPoints[0].y))/d.y;
-		cv::Point2f& A = dstCVPoints[0];
-		cv::Point2f& B = dstCVPoints[1];
-		cv::Point2f& C = dstCVPoints[3];
-		cv::Point2f& D = dstCVPoints[2];
+		// the coefficients are calculated in updateBilinear
+		float u = (x-bilinearOrigin.x)*bilinearScale.x;
+		float v = (y-bilinearOrigin.y)*bilinearScale.y;
+		glm::vec2 result = bilinearA + (bilinearU*u) + (bilinearV*v) + (bilinearUV*(u*v));
 
-		return A + (B-A)*u + (D-A)*v + (A-B+C-D)*u*v;
+		return cv::Point2f(result.x, result.y);
 
 	}
 }
@@ -105,15 +276,8 @@ glm::vec3 Warper::getUnWarpedPoint(const glm::vec3& p, bool useHomography){
 
 
 
-	if (post.size() < 1) pre.resize(1);
-	if (post.size() < 1) pre.resize(1);
-	pre[0].x = p.x;
-	pre[0].y = p.y;
-
-	cv::perspectiveTransform(pre, post, inverseHomography);
-	ofPoint point = p;
-	point.x = post[0].x;
-	point.y = post[0].y;
+	glm::vec3 point = p;
+	transformPoint(inverseHomographyMatrix, p.x, p.y, point.x, point.y);
 
 	return point;
 
@@ -122,15 +286,8 @@ glm::vec3 Warper::getUnWarpedPoint(const glm::vec3& p, bool useHomography){
 
 
 ofxLaser::Point Warper::getUnWarpedPoint(const ofxLaser::Point& p, bool useHomography){
-	if(post.size()<1) pre.resize(1);
-	if(post.size()<1) pre.resize(1);
-	pre[0].x = p.x;
-	pre[0].y = p.y;
-	
-	cv::perspectiveTransform(pre, post, inverseHomography);
 	ofxLaser::Point point =p;
-	point.x = post[0].x;
-	point.y = post[0].y;
+	transformPoint(inverseHomographyMatrix, p.x, p.y, point.x, point.y);
 	
 	return point;
 	
@@ -23,7 +23,20 @@ class Warper {
 //	void setDst(const ofRectangle& rect);
 //	void setDst(float x, float y, float w, float h) ;
 //	
+	// calculates the homography directly from the four corners, src1-4 and
+	// dst1-4 are top left, top right, bottom left, bottom right
 	void updateHomography(glm::vec3 src1, glm::vec3 src2, glm::vec3 src3, glm::vec3 src4, glm::vec3 dst1, glm::vec3 dst2, glm::vec3 dst3, glm::vec3 dst4);
+	// for more than four points this uses a best fit with OpenCV. The first
+	// four points are used for the bilinear warp.
+	bool updateHomography(const vector<glm::vec3>& srcpoints, const vector<glm::vec3>& dstpoints);
+	
+	// the homography that maps the four corners of the unit square
+	// (0,0), (1,0), (1,1), (0,1) to the four points, in that order.
+	// Returns false if the points are degenerate.
+	static bool getSquareToQuadMatrix(const glm::vec2* quad, double* matrix);
+	// returns false if the matrix can't be inverted
+	static bool invertMatrix(const double* matrix, double* inverse);
+	static void multiplyMatrices(const double* a, const double* b, double* result);
 
 	glm::vec3 getWarpedPoint(const glm::vec3& p, bool useHomography = true);
 	Point getWarpedPoint(const Point& p, bool useHomography = true);
@@ -32,6 +45,10 @@ class Warper {
 	Point getUnWarpedPoint(const Point& p, bool useHomography = true);
 	glm::vec3 getUnWarpedPoint(const glm::vec3& p, bool useHomography = true);
 	
+	// warps all the points in place. Uses the cached matrix rather than
+	// going through OpenCV so it's much faster for lots of points.
+	void getWarpedPoints(Point* points, size_t count, bool useHomography = true);
+	
 	cv::Point2f toCv(glm::vec3 p) {
 		return cv::Point2f(p.x, p.y);
 	}
@@ -39,14 +56,32 @@ class Warper {
 		return glm::vec3(p.x, p.y,0);
 	}
 
-	
-	cv::Mat homography;
-	cv::Mat inverseHomography;
+	// copies of the current matrices as OpenCV 3x3 CV_64F matrices
+	cv::Mat getHomography();
+	cv::Mat getInverseHomography();
 	
 	protected:
 	
-	vector<cv::Point2f> pre, post;
+	void setMatrices(const double* matrix, const double* inverse);
+	void updateBilinear(glm::vec3 src1, glm::vec3 src4, glm::vec3 dst1, glm::vec3 dst2, glm::vec3 dst3, glm::vec3 dst4);
+	inline void transformPoint(const float* matrix, float x, float y, float& outx, float& outy) const {
+		// same as cv::perspectiveTransform
+		float w = (matrix[6]*x) + (matrix[7]*y) + matrix[8];
+		w = (fabs(w)>FLT_EPSILON) ? 1.0f/w : 0;
+		outx = ((matrix[0]*x) + (matrix[1]*y) + matrix[2])*w;
+		outy = ((matrix[3]*x) + (matrix[4]*y) + matrix[5])*w;
+	}
+	
 	vector<cv::Point2f> srcCVPoints, dstCVPoints;
+	
+	// copies of the homography matrices as plain floats (row major)
+	float homographyMatrix[9] = {1,0,0, 0,1,0, 0,0,1};
+	float inverseHomographyMatrix[9] = {1,0,0, 0,1,0, 0,0,1};
+	
+	// the bilinear warp as X(u,v) = A + (B-A)·u + (D-A)·v + (A-B+C-D)·u·v
+	glm::vec2 bilinearOrigin;
+	glm::vec2 bilinearScale;
+	glm::vec2 bilinearA, bilinearU, bilinearV, bilinearUV;
 
 private:
 
@@ -201,6 +201,33 @@ ofxLaser::Point ZoneTransform::getWarpedPoint(const ofxLaser::Point& p){
 	return quad.getWarpedPoint(p, useHomography);
 	
 };
+
+void ZoneTransform::getWarpedPoints(ofxLaser::Point* points, size_t count){
+	
+	if((count==0) || quadWarpers.empty()) return;
+	
+	bool homography = useHomography;
+	
+	if(quadWarpers.size()==1) {
+		quadWarpers[0].getWarpedPoints(points, count, homography);
+		return;
+	}
+	
+	// consecutive points are usually in the same subdivision so warp
+	// them in runs. Each point's quad is found before any of the points
+	// after it are warped.
+	size_t runStart = 0;
+	int runQuad = getQuadIndexForPoint(points[0].x, points[0].y);
+	for(size_t i = 1; i<=count; i++) {
+		int quad = (i<count) ? getQuadIndexForPoint(points[i].x, points[i].y) : -1;
+		if(quad!=runQuad) {
+			quadWarpers[runQuad].getWarpedPoints(points+runStart, i-runStart, homography);
+			runStart = i;
+			runQuad = quad;
+		}
+	}
+}
+
 //
 //Point getUnWarpedPoint(const Point& p){
 //	return p;
@@ -238,44 +265,16 @@ void ZoneTransform :: setDstCorners(glm::vec3 topleft, glm::vec3 topright, glm::
 	// interpolate dst handle points?
 	
 	// ofLog(OF_LOG_NOTICE, "ZoneTransform::setDstCorners "+displayLabel);
-	vector<cv::Point2f> srcCVPoints, dstCVPoints;
-	srcCVPoints.resize(4);
-	dstCVPoints.resize(4);
-	
-	srcCVPoints[0] = toCv(srcRect.getTopLeft());
-	srcCVPoints[1] = toCv(srcRect.getTopRight());
-	srcCVPoints[2] = toCv(srcRect.getBottomLeft());
-	srcCVPoints[3] = toCv(srcRect.getBottomRight());
 	
     //cout << topleft << " " << topright << " " << bottomleft << " " << bottomright << endl;
     
-	dstCVPoints[0] = toCv(topleft);
-	dstCVPoints[1] = toCv(topright);
-	dstCVPoints[2] = toCv(bottomleft);
-	dstCVPoints[3] = toCv(bottomright);
-	
-	// NB 8 is CV_RANSAC which isn't defined in all platforms for some reason.
-	cv::Mat homography = cv::findHomography(cv::Mat(srcCVPoints), cv::Mat(dstCVPoints),8, 100);
+	Warper warper;
+	warper.updateHomography(srcRect.getTopLeft(), srcRect.getTopRight(), srcRect.getBottomLeft(), srcRect.getBottomRight(), topleft, topright, bottomleft, bottomright);
 	
-	srcCVPoints.resize(srcPoints.size());
-	dstCVPoints.resize(srcPoints.size());
-	
-
-	for(size_t i= 0; i<srcPoints.size(); i++) {
-		srcCVPoints[i] = toCv(srcPoints[i]);
-	
-	}
-	try {
-		cv::perspectiveTransform(srcCVPoints, dstCVPoints, homography);
-	} catch ( cv::Exception & e ) {
-		ofLog(OF_LOG_ERROR, e.msg ); // output exception message
-	}
-		
 	for(size_t i= 0; i<dstHandles.size(); i++) {
-		dstHandles[i].set(toOf(dstCVPoints[i]));
+		dstHandles[i].set(warper.getWarpedPoint(srcPoints[i]));
         dstHandles[i].col = ofColor(100,100,255, 196);
         dstHandles[i].overCol = ofColor(196,196,255, 255);
-       // ofLog(OF_LOG_NOTICE,"setting dstHandles["+ofToString(i)+"] to "+ofToString(dstCVPoints[i].x)+","+ofToString(dstCVPoints[i].y));
        // ofLog(OF_LOG_NOTICE," ------------------["+ofToString(i)+"] to "+ofToString(dstHandles[i].x)+","+ofToString(dstHandles[i].y));
        
 	}
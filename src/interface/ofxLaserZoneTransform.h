@@ -97,6 +97,9 @@ class ZoneTransform {
 	Point getUnWarpedPoint(const Point& p);
 	ofPoint getWarpedPoint(const ofPoint& p);
 	ofPoint getUnWarpedPoint(const ofPoint& p);
+	// warps the points in place, a run of points at a time for each
+	// subdivision
+	void getWarpedPoints(Point* points, size_t count);
 	
 	ofPoint getCentre(); 
 	
@@ -134,6 +137,14 @@ class ZoneTransform {
     bool visible;
 	bool isDirty;
 	
+	int getQuadIndexForPoint(float x, float y) {
+		int xindex = ((x-srcRect.getLeft()) / srcRect.getWidth()) * (float)(xDivisions);
+		int yindex = ((y-srcRect.getTop()) / srcRect.getHeight()) * (float)(yDivisions);
+		xindex = ofClamp(xindex,0,xDivisions-1);
+		yindex = ofClamp(yindex,0,yDivisions-1);
+		return xindex + (yindex*xDivisions);
+	}
+	
 	bool initialised = false;
 	int xDivisions;
 	int yDivisions;
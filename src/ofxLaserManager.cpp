@@ -278,6 +278,10 @@ void Manager :: renderPreview() {
     for(size_t i= 0; i<shapes.size(); i++) {
         shapes[i]->addPreviewToMesh(mesh);
     }
+    for(RetainedShape* retainedShape : retainedShapes) {
+        Shape* s = retainedShape->getShape();
+        if(s!=NULL) s->addPreviewToMesh(mesh);
+    }
     
     ofRectangle laserRect(0,0,width, height);
     if(useBitmapMask) {
@@ -515,6 +519,9 @@ void Manager::drawLaserGui() {
     UI::addIntSlider(laserManager.testPattern);
     
     UI::addParameterGroup(laserManager.interfaceParams);
+    ImGui::Text("Render time : %.2fms (%d thread%s)", laserManager.getSendTimeMillis(), laserManager.getNumRenderThreads(), laserManager.getNumRenderThreads()==1 ? "" : "s");
+    const ShapeArena& arena = laserManager.getShapeArena();
+    ImGui::Text("Shapes : %d (%d stored, %d new)", arena.getNumShapesUsed(), arena.getNumShapesAllocated(), arena.getNumNewShapesLastFrame());
     
     
     if((!lockInputZones) && (selectedLaser ==-1)) {
@@ -1162,6 +1169,18 @@ void Manager :: drawLaserSettingsPanel(ofxLaser::Laser* laser, float laserpanelw
         ImGui::PopStyleVar(1);
         
         UI::addParameterGroup(laser->advancedParams);
+        
+        ImGui::Text("PERFORMANCE");
+        ImGui::Text("Render time : %.2fms", laser->getRenderTimeMillis());
+        ImGui::Text("Shape sort time : %.2fms", laser->getSortTimeMillis());
+        ImGui::Text("Blank move distance : %.0f", laser->blankMoveDistance);
+        const ofxLaser::ShapeOrderCache& orderCache = laser->getShapeOrderCache();
+        ImGui::Text("Shape order cache : %d hits, %d repairs, %d misses", orderCache.hitCount, orderCache.repairCount, orderCache.missCount);
+        ImGui::Text("Frame buffer growth : %d (%d last frame)", laser->bufferGrowthCount, laser->lastFrameBufferGrowth);
+        for (auto & renderProfilePair : laser->scannerSettings.renderProfiles) {
+            ofxLaser::MotionProfileCache& motionCache = renderProfilePair.second.motionProfileCache;
+            ImGui::Text("%s motion profile cache hits : %.1f%%", renderProfilePair.first.c_str(), motionCache.getHitRate()*100);
+        }
         ImGui::TreePop();
     }
     
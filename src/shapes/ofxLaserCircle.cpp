@@ -11,6 +11,10 @@
 using namespace ofxLaser;
 //class Manager;
 Circle::Circle(const ofPoint& _centre, const float _radius, const ofColor& col, string profilelabel){
+	init(_centre, _radius, col, profilelabel);
+}
+
+void Circle::init(const ofPoint& _centre, const float _radius, const ofColor& col, const string& profilelabel){
 	
 	// seems like an over-engineered way of doing it but it's the only
 	// way to ensure the transformations are taken into account.
@@ -32,38 +36,99 @@ Circle::Circle(const ofPoint& _centre, const float _radius, const ofColor& col,
 		polyline.addVertex(p);
 	}
 	
-	const vector<glm::vec3>& vertices = polyline.getVertices();
+	const ofPolyline& constpoly = polyline;
+	const vector<glm::vec3>& vertices = constpoly.getVertices();
 	
 	startPos = vertices.front();
 	
 	endPos = vertices.back();
 	
 	tested = false;
+	reversed = false;
 	profileLabel = profilelabel;
+	updateBoundingBox();
+	
+}
+
+void Circle::updateBoundingBox() {
 	
+	const ofPolyline& constpoly = polyline;
+	const vector<glm::vec3>& vertices = constpoly.getVertices();
+	boundingBox = constpoly.getBoundingBox();
+	
+	vertexLengths.resize(vertices.size());
+	float length = 0;
+	for(size_t i = 0; i<vertices.size(); i++) {
+		if(i>0) length+=glm::distance(vertices[i-1], vertices[i]);
+		vertexLengths[i] = length;
+	}
+}
+
+glm::vec3 Circle::getPointAtLength(float length) const {
+	
+	const ofPolyline& constpoly = polyline;
+	const vector<glm::vec3>& vertices = constpoly.getVertices();
+	if(vertices.empty()) return centre;
+	if(length<=0) return vertices.front();
+	if(length>=vertexLengths.back()) return vertices.back();
+	
+	// the first vertex that's further along than the length
+	size_t i = std::upper_bound(vertexLengths.begin(), vertexLengths.end(), length) - vertexLengths.begin();
+	float segmentlength = vertexLengths[i] - vertexLengths[i-1];
+	float t = (segmentlength>0) ? (length - vertexLengths[i-1])/segmentlength : 0;
+	return glm::mix(vertices[i-1], vertices[i], t);
 }
 
 void Circle::appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier){
 	
-	float acceleration = profile.acceleration;
-	float speed = profile.speed;
-	float length = polyline.getPerimeter();
+	float length = getLength();
 	
-	vector<float> unitDistances = getPointsAlongDistance(length, acceleration, speed, speedMultiplier);
+	std::shared_ptr<const vector<float>> table = getPointsAlongDistance(profile, length, speedMultiplier);
+	const vector<float>& unitDistances = *table;
 	
 	
 	for(size_t i = 0; i<unitDistances.size(); i++) {
 		
-		ofPoint p = polyline.getPointAtLength((unitDistances[i]* length));
+		ofPoint p = getPointAtLength(unitDistances[i]* length);
 		
 		points.push_back(ofxLaser::Point(p, colour));
 	}
 }
 
+void Circle::appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier){
+	
+	size_t firstpoint = points.size();
+	if(isInsideRect(cliprect)) {
+		appendPointsToVector(points, profile, speedMultiplier);
+		if(points.size()>firstpoint) piecesizes.push_back(points.size()-firstpoint);
+		return;
+	}
+	
+	// resample each of the arcs that are inside on their own
+	static thread_local vector<glm::vec2> ranges;
+	const ofPolyline& constpoly = polyline;
+	getClippedRanges(constpoly.getVertices(), cliprect, ranges);
+	
+	for(glm::vec2& range : ranges) {
+		float length = range.y-range.x;
+		if(length<=0) continue;
+		
+		size_t piecestart = points.size();
+		std::shared_ptr<const vector<float>> table = getPointsAlongDistance(profile, length, speedMultiplier);
+		const vector<float>& unitDistances = *table;
+		for(size_t i = 0; i<unitDistances.size(); i++) {
+			ofPoint p = getPointAtLength(range.x + (unitDistances[i]*length));
+			points.push_back(ofxLaser::Point(p, colour));
+		}
+		if(points.size()>piecestart) piecesizes.push_back(points.size()-piecestart);
+	}
+}
+
 void Circle::addPreviewToMesh(ofMesh& mesh){
 	
 	
-	auto & vertices = polyline.getVertices();
+	const ofPolyline& constpoly = polyline;
+	const vector<glm::vec3>& vertices = constpoly.getVertices();
 	mesh.addColor(ofColor(0));
 	mesh.addVertex(vertices.front());
 	
@@ -81,7 +146,7 @@ void Circle::addPreviewToMesh(ofMesh& mesh){
 bool Circle::intersectsRect(ofRectangle & rect) {
     
     
-    const ofRectangle& bounds = polyline.getBoundingBox();
+    const ofRectangle& bounds = boundingBox;
     
     if(rect.inside(bounds)) {
        //cout << "fast out " << true << endl;
@@ -93,9 +158,10 @@ bool Circle::intersectsRect(ofRectangle & rect) {
         return false;
     }
     
-    vector<glm::vec3>& points = polyline.getVertices();
+    const ofPolyline& constpoly = polyline;
+    const vector<glm::vec3>& points = constpoly.getVertices();
     
-    for(glm::vec3& p : points) {
+    for(const glm::vec3& p : points) {
         if(rect.inside(p)) {
         //    cout << true << endl;
             return true;
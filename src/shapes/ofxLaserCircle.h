@@ -16,15 +16,28 @@ namespace ofxLaser {
 		public:
 		Circle(){};
 		Circle(const ofPoint& _centre, const float _radius, const ofColor& col, string profilelabel);
+		// so that the object can be reused
+		void init(const ofPoint& _centre, const float _radius, const ofColor& col, const string& profilelabel);
+		// call this if the polyline is changed after init, it also works out
+		// the lengths that the points are calculated from
+		void updateBoundingBox();
 		void appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier);
+		void appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) override;
 		
 		virtual bool intersectsRect(ofRectangle & rect);
+		float getLength() override { return vertexLengths.empty() ? 0 : vertexLengths.back(); };
 		
 		void addPreviewToMesh(ofMesh& mesh);
         ofPolyline polyline; // to store the circle shape in once it's been projected
   
 		protected:
 		
+		// the circle can be rendered by more than one laser at once, so
+		// rather than use ofPolyline's lazily cached lengths we work them out
+		// up front and only ever read them
+		glm::vec3 getPointAtLength(float length) const;
+		std::vector<float> vertexLengths;
+		
 	    float radius;
         glm::vec3 centre;
 		
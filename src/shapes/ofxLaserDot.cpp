@@ -10,12 +10,18 @@
 using namespace ofxLaser;
 
 Dot::Dot(const ofPoint& dotPosition, const ofColor& dotColour, float dotIntensity, string profilelabel){
+    init(dotPosition, dotColour, dotIntensity, profilelabel);
+}
+
+void Dot::init(const ofPoint& dotPosition, const ofColor& dotColour, float dotIntensity, const string& profilelabel){
     
     colour = dotColour;
     startPos.set(dotPosition);
     endPos.set(dotPosition);
+    boundingBox.set(dotPosition.x, dotPosition.y, 0, 0);
     intensity = dotIntensity;
     tested = false;
+    reversed = false;
     profileLabel = profilelabel;
     
 }
@@ -35,6 +41,16 @@ void Dot::appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProf
 };
 
 
+void Dot::appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) {
+    
+    // it's either all in or all out
+    if(!isInsideRect(cliprect)) return;
+    size_t firstpoint = points.size();
+    appendPointsToVector(points, profile, speedMultiplier);
+    if(points.size()>firstpoint) piecesizes.push_back(points.size()-firstpoint);
+    
+}
+
 void Dot::addPreviewToMesh(ofMesh& mesh){
     float radius = ofMap(intensity, 0, 1,0.1,1.5, true);
     ofColor c(colour);
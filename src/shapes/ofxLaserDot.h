@@ -14,8 +14,12 @@ class Dot : public Shape{
 	
 	public :
 	
+    Dot(){};
     Dot(const ofPoint& dotPosition, const ofColor& dotColour, float dotIntensity, string profilelabel);
+    // so that the object can be reused
+    void init(const ofPoint& dotPosition, const ofColor& dotColour, float dotIntensity, const string& profilelabel);
     void appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier);
+    void appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) override;
     void addPreviewToMesh(ofMesh& mesh);
     virtual bool intersectsRect(ofRectangle & rect);
 
@@ -11,12 +11,19 @@
 using namespace ofxLaser;
 
 Line::Line(const ofPoint& startpos, const ofPoint& endpos, const ofColor& col, string profilelabel){
+    init(startpos, endpos, col, profilelabel);
+}
+
+void Line::init(const ofPoint& startpos, const ofPoint& endpos, const ofColor& col, const string& profilelabel){
 
     reversable = true;
+    reversed = false;
     colour = col;
     
     startPos = startpos;
     endPos = endpos;
+    boundingBox.set(startPos.x, startPos.y, endPos.x-startPos.x, endPos.y-startPos.y);
+    boundingBox.standardize();
     
     tested = false;
     profileLabel = profilelabel;
@@ -32,7 +39,8 @@ void Line::appendPointsToVector(vector<ofxLaser::Point>& points, const RenderPro
     ofVec2f v = end-start;
 
     float distanceTravelled = ofDist(start.x, start.y, end.x, end.y);
-    vector<float> unitDistances = getPointsAlongDistance(distanceTravelled, profile.acceleration, profile.speed, speedMultiplier);
+    std::shared_ptr<const vector<float>> table = getPointsAlongDistance(profile, distanceTravelled, speedMultiplier);
+    const vector<float>& unitDistances = *table;
     
     ofPoint p;
     
@@ -44,6 +52,31 @@ void Line::appendPointsToVector(vector<ofxLaser::Point>& points, const RenderPro
     }
 };
 
+void Line::appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) {
+    
+    size_t firstpoint = points.size();
+    
+    ofPoint& start = getStartPos();
+    ofPoint& end = getEndPos();
+    float t0, t1;
+    if(!clipLine(glm::vec2(start.x, start.y), glm::vec2(end.x, end.y), cliprect, t0, t1)) return;
+    
+    // just the part that's inside
+    ofVec2f v = end-start;
+    ofPoint clippedstart = start + (v*t0);
+    ofVec2f clippedv = v*(t1-t0);
+    
+    float distanceTravelled = clippedv.length();
+    std::shared_ptr<const vector<float>> table = getPointsAlongDistance(profile, distanceTravelled, speedMultiplier);
+    const vector<float>& unitDistances = *table;
+    
+    for(size_t i = 0; i<unitDistances.size(); i++) {
+        points.push_back(ofxLaser::Point(clippedstart + (clippedv*unitDistances[i]), colour));
+    }
+    if(points.size()>firstpoint) piecesizes.push_back(points.size()-firstpoint);
+    
+}
+
 void Line::addPreviewToMesh(ofMesh& mesh){
     mesh.addColor(ofColor(0));
     mesh.addVertex(getStartPos());
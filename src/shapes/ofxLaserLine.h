@@ -15,14 +15,19 @@ class Line : public Shape{
 	
 	public :
 	
+    Line(){};
     Line(const ofPoint& startpos, const ofPoint& endpos, const ofColor& col, string profilelabel);
+    // so that the object can be reused
+    void init(const ofPoint& startpos, const ofPoint& endpos, const ofColor& col, const string& profilelabel);
 	
 	
 	void appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier);
+	void appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) override;
 	
     void addPreviewToMesh(ofMesh& mesh);
 	
     virtual bool intersectsRect(ofRectangle & rect);
+    float getLength() override { return glm::distance(glm::vec2(startPos.x, startPos.y), glm::vec2(endPos.x, endPos.y)); };
 
 		
 };
@@ -14,7 +14,12 @@ class ManualShape : public Shape{
 	
 	public :
 	
+	ManualShape(){};
 	ManualShape(const vector<ofPoint> allpoints, const vector<ofColor> pointcolours, bool usecalibration, string profilelabel){
+		init(allpoints, pointcolours, usecalibration, profilelabel);
+	}
+	// so that the object can be reused
+	void init(const vector<ofPoint>& allpoints, const vector<ofColor>& pointcolours, bool usecalibration, const string& profilelabel){
 		
 		useCalibration = usecalibration;
 		
@@ -22,6 +27,8 @@ class ManualShape : public Shape{
 		endPos.set(allpoints.back());
 		
 		points = allpoints; // hopefully copies
+		boundingBox.set(points.front().x, points.front().y, 0, 0);
+		for(ofPoint& p : points) boundingBox.growToInclude(p.x, p.y);
 		colours = pointcolours;
 		
 		while(colours.size()<points.size()) {
@@ -14,7 +14,6 @@ Polyline::Polyline() {
 	
 	reversable = true;
 	colour = ofColor::white;
-	cachedProfile = NULL;
 	multicoloured = false;
 	
 	tested = false;
@@ -33,29 +32,31 @@ Polyline::Polyline(const ofPolyline& poly, const vector<ofColor>& sourcecolours,
 
 }
 
-void Polyline::init(const ofPolyline& poly, const ofColor& col, string profilelabel){
+void Polyline::init(const ofPolyline& poly, const ofColor& col, const string& profilelabel){
 	
 	reversable = true;
 	colour = col;
-	cachedProfile = NULL;
+	clearCaches();
 	multicoloured = false;
 	
 	tested = false;
+	reversed = false;
 	profileLabel = profilelabel;
 	
 	initPoly(poly);
 	
 }
 
-void Polyline::init(const ofPolyline& poly, const vector<ofColor>& sourcecolours, string profilelabel){
+void Polyline::init(const ofPolyline& poly, const vector<ofColor>& sourcecolours, const string& profilelabel){
 	
 	reversable = true;
-	cachedProfile = NULL;
+	clearCaches();
 	
 	multicoloured = true;
 	colours = sourcecolours; // should copy
 	
 	tested = false;
+	reversed = false;
 	profileLabel = profilelabel;
 	
 	
@@ -89,12 +90,17 @@ void Polyline::initPoly(const ofPolyline& poly){
 		polyline.addVertex(polyline.getVertices().front());
     	polyline.setClosed(false);
 	}
-	const vector<glm::vec3>& vertices = polyline.getVertices();
+	const ofPolyline& constpoly = polyline;
+	const vector<glm::vec3>& vertices = constpoly.getVertices();
 	
 	startPos = vertices.front();
 	// to avoid a bug in polyline in open polys
 	endPos = vertices.back();
-	boundingBox = polyline.getBoundingBox();
+	boundingBox = constpoly.getBoundingBox();
+	
+	// the lengths and corner angles only depend on the polyline, and
+	// working them out now means the render threads only ever read them
+	calculateVertexData();
    
 	
 }
@@ -110,63 +116,219 @@ Polyline:: ~Polyline() {
 	}
 }
 
+void Polyline::setColour(const ofColor& col) {
+	
+	colour = col;
+	multicoloured = false;
+	
+	// the cached points are all the same colour so we can just change them
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	for(PointCache& cache : pointCaches) {
+		for(ofxLaser::Point& p : cache.points) {
+			p.r = col.r;
+			p.g = col.g;
+			p.b = col.b;
+		}
+	}
+	for(PointCache& cache : clippedPointCaches) {
+		for(ofxLaser::Point& p : cache.points) {
+			p.r = col.r;
+			p.g = col.g;
+			p.b = col.b;
+		}
+	}
+}
+
+void Polyline::setColours(const vector<ofColor>& sourcecolours) {
+	
+	colours = sourcecolours;
+	multicoloured = true;
+	
+	// we don't know which vertex each cached point came from so they
+	// need recalculating
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	clearCaches();
+}
+
+bool Polyline::PointCache::matches(const RenderProfile& p, float speedmultiplier) const {
+	return (profile==&p) && (speed==p.speed.get()) && (acceleration==p.acceleration.get()) && (cornerThreshold==p.cornerThreshold.get()) && (speedMultiplier==speedmultiplier);
+}
+
+void Polyline::PointCache::set(const RenderProfile& p, float speedmultiplier) {
+	profile = &p;
+	speed = p.speed;
+	acceleration = p.acceleration;
+	cornerThreshold = p.cornerThreshold;
+	speedMultiplier = speedmultiplier;
+}
+
+Polyline::PointCache& Polyline::getCacheForProfile(std::vector<PointCache>& caches, const RenderProfile& profile) {
+	PointCache* unused = NULL;
+	for(PointCache& cache : caches) {
+		if(cache.profile==&profile) return cache;
+		if((cache.profile==NULL) && (unused==NULL)) unused = &cache;
+	}
+	if(unused!=NULL) return *unused;
+	caches.emplace_back();
+	return caches.back();
+}
+
+Polyline::PointCache* Polyline::findClippedCache(const RenderProfile& profile, const ofRectangle& cliprect) {
+	for(PointCache& cache : clippedPointCaches) {
+		if((cache.profile==&profile) && (cache.clipRect==cliprect)) return &cache;
+	}
+	return NULL;
+}
+
+Polyline::PointCache& Polyline::getClippedCache(const RenderProfile& profile, const ofRectangle& cliprect) {
+	PointCache* found = findClippedCache(profile, cliprect);
+	if(found!=NULL) return *found;
+	for(PointCache& cache : clippedPointCaches) {
+		if(cache.profile==NULL) return cache;
+	}
+	if(clippedPointCaches.size()<maxClippedCaches) {
+		clippedPointCaches.emplace_back();
+		return clippedPointCaches.back();
+	}
+	PointCache& cache = clippedPointCaches[nextClippedCacheToReplace];
+	nextClippedCacheToReplace = (nextClippedCacheToReplace+1)%maxClippedCaches;
+	return cache;
+}
+
+void Polyline::clearCaches() {
+	for(PointCache& cache : pointCaches) cache.profile = NULL;
+	for(PointCache& cache : clippedPointCaches) cache.profile = NULL;
+}
+
 void Polyline::appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier) {
 	
-	// TODO - take into account the speed multiplier!
-	ofPolyline& polyline = *polylinePointer;
-	if(&profile == cachedProfile) {
-//		ofLog(OF_LOG_NOTICE, "cached points used");
-		points.insert(points.end(), cachedPoints.begin(), cachedPoints.end());
+	// the same shape can be rendered by more than one laser at the same
+	// time, so the cache is only touched while we have the lock
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		PointCache& cache = getCacheForProfile(pointCaches, profile);
+		if(cache.matches(profile, speedMultiplier)) {
+			points.insert(points.end(), cache.points.begin(), cache.points.end());
+			return;
+		}
+	}
+	
+	if(vertexLengths.empty()) return;
+	size_t firstPointIndex = points.size();
+	
+	appendPointsForRange(points, profile, speedMultiplier, 0, vertexLengths.back());
+	
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	PointCache& cache = getCacheForProfile(pointCaches, profile);
+	cache.set(profile, speedMultiplier);
+	cache.points.assign(points.begin()+firstPointIndex, points.end());
+	
+}
+
+void Polyline::appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) {
+	
+	size_t firstPointIndex = points.size();
+	
+	if(isInsideRect(cliprect)) {
+		appendPointsToVector(points, profile, speedMultiplier);
+		if(points.size()>firstPointIndex) piecesizes.push_back(points.size()-firstPointIndex);
 		return;
 	}
+	
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		PointCache* cache = findClippedCache(profile, cliprect);
+		if((cache!=NULL) && cache->matches(profile, speedMultiplier)) {
+			points.insert(points.end(), cache->points.begin(), cache->points.end());
+			piecesizes.insert(piecesizes.end(), cache->pieceSizes.begin(), cache->pieceSizes.end());
+			return;
+		}
+	}
+	
+	// only the parts that are inside the rectangle get resampled, and
+	// each one starts and ends exactly on the edge
+	static thread_local vector<glm::vec2> ranges;
+	const ofPolyline& polyline = *polylinePointer;
+	getClippedRanges(polyline.getVertices(), cliprect, ranges);
+	
+	size_t firstPieceIndex = piecesizes.size();
+	for(glm::vec2& range : ranges) {
+		size_t piecestart = points.size();
+		appendPointsForRange(points, profile, speedMultiplier, range.x, range.y);
+		if(points.size()>piecestart) piecesizes.push_back(points.size()-piecestart);
+	}
+	
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	PointCache& cache = getClippedCache(profile, cliprect);
+	cache.set(profile, speedMultiplier);
+	cache.clipRect = cliprect;
+	cache.points.assign(points.begin()+firstPointIndex, points.end());
+	cache.pieceSizes.assign(piecesizes.begin()+firstPieceIndex, piecesizes.end());
+	
+}
 
-	cachedProfile = &profile;
-	cachedPoints.clear();
+void Polyline::appendPointsForRange(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier, float rangestart, float rangeend) {
+	
+	const ofPolyline& polyline = *polylinePointer;
+	const vector<glm::vec3>& vertices = polyline.getVertices();
 	
-	float acceleration = profile.acceleration;
-	float speed = profile.speed;
 	float cornerThresholdAngle = profile.cornerThreshold;
 
 	int startpoint = 0;
 	int endpoint = 0;
 	
-	int numVertices =(int)polyline.size();
+	int numVertices =(int)vertices.size();
 	while(endpoint<numVertices-1) {
 		
 		do {
 			endpoint++;
-		} while ((endpoint< (int)polyline.size()-1) && abs(polyline.getDegreesAtIndex(endpoint)) < cornerThresholdAngle);
+		} while ((endpoint< numVertices-1) && abs(vertexDegrees[endpoint]) < cornerThresholdAngle);
 		
-		
-		float startdistance = polyline.getLengthAtIndex(startpoint);
-		float enddistance = polyline.getLengthAtIndex(endpoint);
+		// the part of this section that's in the range
+		float startdistance = MAX(vertexLengths[startpoint], rangestart);
+		float enddistance = MIN(vertexLengths[endpoint], rangeend);
 		
 		float length = enddistance - startdistance;
 		
-		ofPoint lastpoint;
-		
 		if(length>0) {
 			
-			vector<float>& unitDistances = getPointsAlongDistance(length, acceleration, speed, speedMultiplier);
+			std::shared_ptr<const vector<float>> table = getPointsAlongDistance(profile, length, speedMultiplier);
+			const vector<float>& unitDistances = *table;
+			
+			// the last point stops just short of the corner, but if the
+			// section is cut by the range we want to end right on the edge
+			float endscale = (enddistance<vertexLengths[endpoint]) ? 1.0f : 0.999f;
 			
+			// the distances only ever go up, so rather than searching for
+			// the segment for each one, we just walk along the vertices
+			int segment = startpoint;
 			
 			for(size_t i = 0; i<unitDistances.size(); i++) {
 				
-				float distanceAlongPoly = (unitDistances[i]*0.999* length) + startdistance;
+				float distanceAlongPoly = (unitDistances[i]*endscale* length) + startdistance;
+				
+				while((segment<endpoint-1) && (vertexLengths[segment+1]<distanceAlongPoly)) {
+					segment++;
+				}
+				
+				float segmentlength = vertexLengths[segment+1] - vertexLengths[segment];
+				float t = (segmentlength>0) ? (distanceAlongPoly - vertexLengths[segment]) / segmentlength : 0;
+				t = ofClamp(t, 0, 1);
 				
-				ofPoint p = polyline.getPointAtLength(distanceAlongPoly);
+				const glm::vec3& v1 = vertices[segment];
+				const glm::vec3& v2 = vertices[segment+1];
+				ofPoint p(v1.x + (v2.x-v1.x)*t, v1.y + (v2.y-v1.y)*t, v1.z + (v2.z-v1.z)*t);
 				
-				if(multicoloured) {
-					int colourindex = round(polyline.getIndexAtLength(distanceAlongPoly)); // TODO - interpolate?
-					colourindex = ofClamp(colourindex, 0,colours.size());
-					cachedPoints.push_back(ofxLaser::Point(p, colours[colourindex]));
+				if(multicoloured && !colours.empty()) {
+					int colourindex = round(segment + t); // TODO - interpolate?
+					colourindex = ofClamp(colourindex, 0, (int)colours.size()-1);
+					points.push_back(ofxLaser::Point(p, colours[colourindex]));
 					
 				} else {
 					
-					cachedPoints.push_back(ofxLaser::Point(p, colour));
+					points.push_back(ofxLaser::Point(p, colour));
 				}
 				
-				lastpoint = p;
 			}
 			
 		}
@@ -174,13 +336,47 @@ void Polyline::appendPointsToVector(vector<ofxLaser::Point>& points, const Rende
 		startpoint=endpoint;
 		
 	}
-	points.insert(points.end(), cachedPoints.begin(), cachedPoints.end());
 	
 }
 
+void Polyline :: calculateVertexData() {
+	
+	// these match the values that ofPolyline calculates for
+	// getLengthAtIndex and getDegreesAtIndex
+	const ofPolyline& polyline = *polylinePointer;
+	const vector<glm::vec3>& vertices = polyline.getVertices();
+	size_t numVertices = vertices.size();
+	
+	vertexLengths.resize(numVertices);
+	vertexDegrees.resize(numVertices);
+	
+	float length = 0;
+	for(size_t i = 0; i<numVertices; i++) {
+		if(i>0) length+=glm::distance(vertices[i-1], vertices[i]);
+		vertexLengths[i] = length;
+		
+		if((i==0) || (i==numVertices-1)) {
+			// the polyline is always open so there's no angle at the ends
+			vertexDegrees[i] = 0;
+		} else {
+			glm::vec3 d1 = vertices[i-1] - vertices[i];
+			glm::vec3 d2 = vertices[i+1] - vertices[i];
+			// like ofPolyline, a repeated vertex doesn't make a corner
+			// (normalizing a zero length vector would give us NaNs)
+			if((glm::dot(d1, d1)==0) || (glm::dot(d2, d2)==0)) {
+				vertexDegrees[i] = 0;
+			} else {
+				glm::vec3 v1 = glm::normalize(d1);
+				glm::vec3 v2 = glm::normalize(d2);
+				vertexDegrees[i] = ofRadToDeg(glm::pi<float>() - acosf(ofClamp(glm::dot(v1, v2), -1.f, 1.f)));
+			}
+		}
+	}
+}
+
 void Polyline :: addPreviewToMesh(ofMesh& mesh){
 	
-	ofPolyline& polyline = *polylinePointer;
+	const ofPolyline& polyline = *polylinePointer;
 	const vector<glm::vec3>& vertices = polyline.getVertices();
 	mesh.addColor(ofColor(0));
 	mesh.addVertex(vertices.front());
@@ -202,8 +398,32 @@ void Polyline :: addPreviewToMesh(ofMesh& mesh){
 }
 
 
+float Polyline:: getLength() {
+	return vertexLengths.empty() ? 0 : vertexLengths.back();
+}
+
+float Polyline:: getPointEstimate(const RenderProfile& profile, float speedMultiplier) {
+	
+	// the same sections as appendPointsForRange
+	int numVertices = (int)vertexLengths.size();
+	float numPoints = 0;
+	int startpoint = 0;
+	int endpoint = 0;
+	while(endpoint<numVertices-1) {
+		do {
+			endpoint++;
+		} while ((endpoint< numVertices-1) && abs(vertexDegrees[endpoint]) < profile.cornerThreshold);
+		
+		float length = vertexLengths[endpoint] - vertexLengths[startpoint];
+		if(length>0) numPoints+=getPointsAlongDistance(profile, length, speedMultiplier)->size();
+		startpoint = endpoint;
+	}
+	return numPoints;
+	
+}
+
 bool Polyline:: intersectsRect(ofRectangle & rect){
-	ofPolyline& polyline = *polylinePointer;
+	const ofPolyline& polyline = *polylinePointer;
 	if(!rect.intersects(boundingBox)) return false;
 	const vector<glm::vec3> & vertices = polyline.getVertices();
 	for(size_t i = 1; i< vertices.size(); i++) {
@@ -19,24 +19,75 @@ namespace ofxLaser {
 		
 		Polyline(const ofPolyline& poly, const ofColor& col, string profilelabel);
 		Polyline(const ofPolyline& poly, const vector<ofColor>& colours, string profilelabel);
-		void init(const ofPolyline& poly, const ofColor& col, string profilelabel);
-		void init(const ofPolyline& poly, const vector<ofColor>& colours, string profilelabel);
+		void init(const ofPolyline& poly, const ofColor& col, const string& profilelabel);
+		void init(const ofPolyline& poly, const vector<ofColor>& colours, const string& profilelabel);
 		
 		
 		~Polyline();
 		
+		// changes the colour without recalculating the points
+		void setColour(const ofColor& col);
+		void setColours(const vector<ofColor>& colours);
+		
 		void appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier);
+		void appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) override;
 		
 		void addPreviewToMesh(ofMesh& mesh);
 		virtual bool intersectsRect(ofRectangle & rect);
+		float getLength() override;
+		// the laser stops at each corner, so each section between them is
+		// counted separately
+		float getPointEstimate(const RenderProfile& profile, float speedMultiplier) override;
 		
 		protected :
 		void initPoly(const ofPolyline& poly);
+		void calculateVertexData();
+		// resamples the part of the polyline between the two distances along it
+		void appendPointsForRange(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier, float rangestart, float rangeend);
+		
 		ofPolyline* polylinePointer = NULL;
-		const RenderProfile* cachedProfile;
-		std::vector<ofxLaser::Point> cachedPoints;
+		
+		// the points are cached for each render profile (so each laser has
+		// its own) along with the settings they were made with, so if the
+		// profile is changed they're recalculated
+		struct PointCache {
+			const RenderProfile* profile = NULL;
+			float speed;
+			float acceleration;
+			float cornerThreshold;
+			float speedMultiplier;
+			// only used for the clipped points
+			ofRectangle clipRect;
+			std::vector<ofxLaser::Point> points;
+			std::vector<size_t> pieceSizes;
+			
+			bool matches(const RenderProfile& profile, float speedmultiplier) const;
+			void set(const RenderProfile& profile, float speedmultiplier);
+		};
+		// returns the entry for the profile, or an unused one
+		static PointCache& getCacheForProfile(std::vector<PointCache>& caches, const RenderProfile& profile);
+		// same but for the clipped points, which have an entry for each
+		// profile and clip rectangle (so one for each zone the shape is in).
+		// find returns NULL if there isn't one yet.
+		PointCache* findClippedCache(const RenderProfile& profile, const ofRectangle& cliprect);
+		PointCache& getClippedCache(const RenderProfile& profile, const ofRectangle& cliprect);
+		// marks all the entries as unused, but keeps their memory
+		void clearCaches();
+		std::vector<PointCache> pointCaches;
+		// for shapes that go over the edge of a zone
+		std::vector<PointCache> clippedPointCaches;
+		// so that moving a zone doesn't keep adding entries, once there are
+		// this many the old ones get replaced in turn
+		static const size_t maxClippedCaches = 16;
+		size_t nextClippedCacheToReplace = 0;
+		std::mutex cacheMutex;
+		
+		// the distance along the polyline and the corner angle at each
+		// vertex, worked out in init
+		std::vector<float> vertexLengths;
+		std::vector<float> vertexDegrees;
+		
 		std::vector<ofColor> colours;
 		bool multicoloured;
-		ofRectangle boundingBox; 
 	};
 }
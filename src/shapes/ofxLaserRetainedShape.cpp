@@ -0,0 +1,113 @@
+//
+//  ofxLaserRetainedShape.cpp
+//  ofxLaser
+//
+//
+
+#include "ofxLaserRetainedShape.h"
+
+using namespace ofxLaser;
+
+RetainedShape :: RetainedShape(const ofPolyline& poly, const ofColor& col, string profilelabel) {
+    sourcePolyline = poly;
+    colour = col;
+    profileLabel = profilelabel;
+}
+
+RetainedShape :: RetainedShape(const ofPolyline& poly, const vector<ofColor>& cols, string profilelabel) {
+    sourcePolyline = poly;
+    colours = cols;
+    multicoloured = true;
+    profileLabel = profilelabel;
+}
+
+void RetainedShape :: setPolyline(const ofPolyline& poly) {
+    sourcePolyline = poly;
+    geometryChanged = true;
+}
+
+void RetainedShape :: setColour(const ofColor& col) {
+    if(!multicoloured && (col==colour)) return;
+    colour = col;
+    multicoloured = false;
+    colourChanged = true;
+}
+
+void RetainedShape :: setColours(const vector<ofColor>& cols) {
+    if(multicoloured && (cols==colours)) return;
+    colours = cols;
+    multicoloured = true;
+    colourChanged = true;
+}
+
+void RetainedShape :: setPosition(const glm::vec2& pos) {
+    if(pos==position) return;
+    position = pos;
+    geometryChanged = true;
+}
+
+void RetainedShape :: setRotation(float degrees) {
+    if(degrees==rotation) return;
+    rotation = degrees;
+    geometryChanged = true;
+}
+
+void RetainedShape :: setScale(float s) {
+    setScale(glm::vec2(s,s));
+}
+
+void RetainedShape :: setScale(const glm::vec2& s) {
+    if(s==scale) return;
+    scale = s;
+    geometryChanged = true;
+}
+
+void RetainedShape :: setVisible(bool v) {
+    visible = v;
+}
+
+void RetainedShape :: setTargetZone(int zonenumber) {
+    targetZone = zonenumber;
+    polyline.setTargetZone(zonenumber);
+}
+
+void RetainedShape :: setProfileLabel(string profilelabel) {
+    // the points are cached per profile so there's no need to rebuild
+    profileLabel = profilelabel;
+    polyline.profileLabel = profilelabel;
+}
+
+Shape* RetainedShape :: getShape() {
+
+    if(geometryChanged) {
+
+        transformedPolyline = sourcePolyline;
+        if((rotation!=0) || (scale!=glm::vec2(1,1)) || (position!=glm::vec2(0,0))) {
+            float angle = ofDegToRad(rotation);
+            for(glm::vec3& v : transformedPolyline.getVertices()) {
+                v = glm::rotateZ(v*glm::vec3(scale.x, scale.y, 1), angle) + glm::vec3(position.x, position.y, 0);
+            }
+        }
+
+        // same check as drawPoly
+        empty = (transformedPolyline.size()==0) || (transformedPolyline.getPerimeter()<0.01);
+
+        if(!empty) {
+            // init clears the cached points
+            if(multicoloured) polyline.init(transformedPolyline, colours, profileLabel);
+            else polyline.init(transformedPolyline, colour, profileLabel);
+            polyline.setTargetZone(targetZone);
+        }
+        geometryChanged = false;
+        colourChanged = false;
+
+    } else if(colourChanged) {
+        if(multicoloured) polyline.setColours(colours);
+        else polyline.setColour(colour);
+        colourChanged = false;
+    }
+
+    if((!visible) || empty) return NULL;
+    else return &polyline;
+
+}
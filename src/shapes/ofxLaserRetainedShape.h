@@ -0,0 +1,79 @@
+//
+//  ofxLaserRetainedShape.h
+//  ofxLaser
+//
+//
+
+#pragma once
+#include "ofxLaserPolyline.h"
+
+namespace ofxLaser {
+
+// A shape that stays in the laser manager until it's deleted, rather than
+// being thrown away at the end of each frame like the shapes from the draw
+// functions. Create it once with one of the manager's addRetained functions
+// and keep the pointer to change it.
+//
+// The points are only recalculated when the geometry or the transform
+// changes. If only the colour changes, the existing points are recoloured.
+//
+// Retained shapes are in canvas coordinates and aren't affected by the
+// current openGL transform, use setPosition, setRotation and setScale
+// instead.
+class RetainedShape {
+
+    public :
+
+    RetainedShape(const ofPolyline& poly, const ofColor& col, string profilelabel);
+    RetainedShape(const ofPolyline& poly, const vector<ofColor>& cols, string profilelabel);
+
+    void setPolyline(const ofPolyline& poly);
+    const ofPolyline& getPolyline() { return sourcePolyline; };
+
+    void setColour(const ofColor& col);
+    void setColours(const vector<ofColor>& cols);
+    const ofColor& getColour() { return colour; };
+
+    void setPosition(const glm::vec2& pos);
+    void setRotation(float degrees);
+    void setScale(float scale);
+    void setScale(const glm::vec2& scale);
+    const glm::vec2& getPosition() { return position; };
+    float getRotation() { return rotation; };
+    const glm::vec2& getScale() { return scale; };
+
+    void setVisible(bool visible);
+    bool isVisible() { return visible; };
+
+    void setTargetZone(int zonenumber); // only relevant for OFXLASER_ZONE_MANUAL
+    void setProfileLabel(string profilelabel);
+
+    // called by the manager each frame, updates the shape if anything has
+    // changed. Returns NULL if the shape is hidden or has nothing to draw.
+    Shape* getShape();
+
+    protected :
+
+    ofPolyline sourcePolyline;
+    ofPolyline transformedPolyline;
+
+    ofColor colour;
+    vector<ofColor> colours;
+    bool multicoloured = false;
+
+    glm::vec2 position = glm::vec2(0,0);
+    float rotation = 0;
+    glm::vec2 scale = glm::vec2(1,1);
+
+    bool visible = true;
+    int targetZone = 0;
+    string profileLabel;
+
+    bool geometryChanged = true;
+    bool colourChanged = false;
+    bool empty = true;
+
+    Polyline polyline;
+
+};
+}
@@ -9,67 +9,25 @@
 
 using namespace ofxLaser;
 
-vector<float>& Shape :: getPointsAlongDistance(float distance, float acceleration, float speed, float speedMultiplier){
+void Shape :: getPointsAlongDistance(vector<float>& unitDistances, float distance, float acceleration, float speed, float speedMultiplier){
     
-    speed*=speedMultiplier;
-    acceleration*=speedMultiplier;
-    unitDistances.clear();
+    MotionProfileCache::calculateUnitDistances(unitDistances, distance, acceleration, speed, speedMultiplier);
     
-    float acceleratedistance = (speed*speed) / (2*acceleration);
-    float timetogettospeed = speed / acceleration;
-    
-    float totaldistance = distance;
-    
-    float constantspeeddistance = totaldistance - (acceleratedistance*2);
-    float constantspeedtime = constantspeeddistance/speed;
-    
-    if(totaldistance<(acceleratedistance*2)) {
-        
-        constantspeeddistance = 0 ;
-        constantspeedtime = 0;
-        acceleratedistance = totaldistance/2;
-        speed = sqrt( acceleratedistance * 2 * acceleration);
-        timetogettospeed = speed / acceleration;
-        
-    }
-    
-    float totaltime = (timetogettospeed*2) + constantspeedtime;
-    
-    float timeincrement = totaltime / (floor(totaltime));
-    
-    float currentdistance;
-    
-    float t = 0;
-    
-    while (t <= totaltime + 0.001) {
-        
-        if(t>totaltime) t = totaltime;
-        
-        if(t <=timetogettospeed) {
-            currentdistance = 0.5 * acceleration * (t*t);
-            
-        } else if((t>timetogettospeed) && (t<=timetogettospeed+constantspeedtime)){
-            currentdistance = acceleratedistance + ((t-timetogettospeed) * speed);
-            
-        } else  {
-            float t3 = t - (timetogettospeed + constantspeedtime);
-            
-            currentdistance = (acceleratedistance + constantspeeddistance) + (speed*t3)+(0.5 *(-acceleration) * (t3*t3));
-            
-            
-        }
-        
-        unitDistances.push_back(currentdistance/totaldistance);
-        
-        t+=timeincrement;
-        
-    }
+}
+
+std::shared_ptr<const vector<float>> Shape :: getPointsAlongDistance(const RenderProfile& profile, float distance, float speedMultiplier){
     
-    return unitDistances;
+    return profile.motionProfileCache.getUnitDistances(distance, profile.acceleration, profile.speed, speedMultiplier);
     
 }
 
 
+float Shape :: getPointEstimate(const RenderProfile& profile, float speedMultiplier) {
+    float length = getLength();
+    if(length<=0) return profile.dotMaxPoints;
+    return getPointsAlongDistance(profile, length, speedMultiplier)->size();
+}
+
 ofPoint& Shape :: getStartPos(){
     if(reversed && reversable) return endPos;
     else return startPos;
@@ -86,6 +44,108 @@ void Shape :: appendPointsToVector(vector<ofxLaser::Point>& points, const Render
     
 };
 
+void Shape :: appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier) {
+    
+    // the shapes that know their geometry override this. For anything else
+    // we get all the points and then cut them at the edges
+    size_t firstpoint = points.size();
+    appendPointsToVector(points, profile, speedMultiplier);
+    if(isInsideRect(cliprect)) {
+        if(points.size()>firstpoint) piecesizes.push_back(points.size()-firstpoint);
+        return;
+    }
+    
+    // the same shape can be rendered by more than one laser at once
+    static thread_local vector<Point> pointbuffer;
+    pointbuffer.assign(points.begin()+firstpoint, points.end());
+    points.resize(firstpoint);
+    
+    size_t piecestart = points.size();
+    bool inside = false;
+    for(size_t i = 0; i<pointbuffer.size(); i++) {
+        const Point& p = pointbuffer[i];
+        bool pointinside = (p.x>=cliprect.getLeft()) && (p.x<=cliprect.getRight()) && (p.y>=cliprect.getTop()) && (p.y<=cliprect.getBottom());
+        
+        if(pointinside!=inside) {
+            if(pointinside) piecestart = points.size();
+            
+            // add the point where the line from the last point crosses the edge
+            float t0, t1;
+            if((i>0) && clipLine(glm::vec2(pointbuffer[i-1].x, pointbuffer[i-1].y), glm::vec2(p.x, p.y), cliprect, t0, t1)) {
+                const Point& last = pointbuffer[i-1];
+                float t = pointinside ? t0 : t1;
+                Point edgepoint = pointinside ? p : last;
+                edgepoint.x = last.x + (p.x-last.x)*t;
+                edgepoint.y = last.y + (p.y-last.y)*t;
+                points.push_back(edgepoint);
+            }
+            
+            if(!pointinside) piecesizes.push_back(points.size()-piecestart);
+            inside = pointinside;
+        }
+        if(pointinside) points.push_back(p);
+    }
+    if(inside) piecesizes.push_back(points.size()-piecestart);
+    
+}
+
+bool Shape :: isInsideRect(const ofRectangle& rect) const {
+    return (boundingBox.getLeft()>=rect.getLeft()) && (boundingBox.getRight()<=rect.getRight()) && (boundingBox.getTop()>=rect.getTop()) && (boundingBox.getBottom()<=rect.getBottom());
+}
+
+bool Shape :: clipLine(const glm::vec2& start, const glm::vec2& end, const ofRectangle& rect, float& t0, float& t1) {
+    
+    // Liang-Barsky
+    glm::vec2 d = end-start;
+    float p[4] = {-d.x, d.x, -d.y, d.y};
+    float q[4] = {start.x-rect.getLeft(), rect.getRight()-start.x, start.y-rect.getTop(), rect.getBottom()-start.y};
+    t0 = 0;
+    t1 = 1;
+    for(int i = 0; i<4; i++) {
+        if(p[i]==0) {
+            // parallel to this edge, so either all in or all out
+            if(q[i]<0) return false;
+        } else {
+            float t = q[i]/p[i];
+            if(p[i]<0) {
+                if(t>t1) return false;
+                if(t>t0) t0 = t;
+            } else {
+                if(t<t0) return false;
+                if(t<t1) t1 = t;
+            }
+        }
+    }
+    return true;
+    
+}
+
+void Shape :: getClippedRanges(const vector<glm::vec3>& vertices, const ofRectangle& rect, vector<glm::vec2>& ranges) {
+    
+    ranges.clear();
+    float length = 0;
+    for(size_t i = 1; i<vertices.size(); i++) {
+        glm::vec2 start(vertices[i-1].x, vertices[i-1].y);
+        glm::vec2 end(vertices[i].x, vertices[i].y);
+        // clipped in 2D but measured in 3D so the distances match the
+        // vertex lengths that the shapes resample with
+        float segmentlength = glm::distance(vertices[i-1], vertices[i]);
+        float t0, t1;
+        if(clipLine(start, end, rect, t0, t1)) {
+            float rangestart = length + (t0*segmentlength);
+            float rangeend = length + (t1*segmentlength);
+            // join it on to the last one if it carries on from it
+            if((!ranges.empty()) && (t0==0) && (ranges.back().y>=rangestart)) {
+                ranges.back().y = rangeend;
+            } else {
+                ranges.push_back(glm::vec2(rangestart, rangeend));
+            }
+        }
+        length+=segmentlength;
+    }
+    
+}
+
 void Shape :: setTargetZone(int zonenumber) {
     targetZoneNumber = zonenumber;
 }
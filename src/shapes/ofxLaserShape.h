@@ -21,16 +21,39 @@ class Shape {
 	};
 	virtual void addPreviewToMesh(ofMesh& mesh) =0;
 	
-    vector<float>& getPointsAlongDistance(float distance, float acceleration, float speed, float speedMultiplier);
-
-	vector<float> unitDistances;
+    // fills the vector with the proportions along the distance of each point
+    static void getPointsAlongDistance(vector<float>& unitdistances, float distance, float acceleration, float speed, float speedMultiplier);
+    // gets the points from the render profile's cache
+    static std::shared_ptr<const vector<float>> getPointsAlongDistance(const RenderProfile& profile, float distance, float speedMultiplier);
 
     virtual ofPoint& getStartPos();
     virtual ofPoint& getEndPos();
 	
     virtual ofFloatColor& getColour();
     virtual void appendPointsToVector(vector<ofxLaser::Point>& points, const RenderProfile& profile, float speedMultiplier) ;
+    // adds the points for the parts of the shape that are inside cliprect
+    // (including the edges). The shape might be split into more than one
+    // piece, the number of points in each piece is added to piecesizes.
+    virtual void appendClippedPointsToVector(vector<ofxLaser::Point>& points, vector<size_t>& piecesizes, const ofRectangle& cliprect, const RenderProfile& profile, float speedMultiplier);
     virtual bool intersectsRect(ofRectangle & rect) = 0;
+    // worked out when the shape is initialised
+    const ofRectangle& getBoundingBox() const { return boundingBox; };
+    // the distance the laser travels to draw the shape, 0 for dots
+    virtual float getLength() { return 0; };
+    // roughly how many points it'll take to draw the shape, not including
+    // moving to it
+    virtual float getPointEstimate(const RenderProfile& profile, float speedMultiplier);
+    // true if the bounding box is inside the rectangle or on its edge
+    bool isInsideRect(const ofRectangle& rect) const;
+    
+    // the part of the line from start to end that's inside the rectangle
+    // (including the edges), as proportions along it. Returns false if it
+    // doesn't go in the rectangle.
+    static bool clipLine(const glm::vec2& start, const glm::vec2& end, const ofRectangle& rect, float& t0, float& t1);
+    // the distances along the lines between the vertices of the parts that
+    // are inside the rectangle, as start and end pairs. The clipping is in
+    // 2D but the distances include z.
+    static void getClippedRanges(const vector<glm::vec3>& vertices, const ofRectangle& rect, vector<glm::vec2>& ranges);
 	
     void setTargetZone(int zonenumber);
 	
@@ -49,6 +72,7 @@ class Shape {
 	ofPoint endPos;
 	ofFloatColor colour;
 	int targetZoneNumber = 0;
+	ofRectangle boundingBox;
 	
 
 };